@@ -1,10 +1,13 @@
 // Main entry point of the program.
-// We perform the parameter sweeps across the width_height and iterations parameters here,
-// and write the results to JSON files.
+// We perform the parameter sweeps (given on the command line, or the defaults below) here,
+// and write the results to JSON files. Run with --help for the options.
 
 // Alternatively, if VIS_SDL2 is defined, the program will run a simple SDL2 preview of the cellular automaton.
 // This requires building with cmake instead of make, as SDL2 is not included in the makefile.
 
+// Passing a checkpoint, RLE or plaintext pattern file as an argument starts from that file
+// instead of a random world: the preview shows it, and otherwise one benchmark set is run on it.
+
 // #define VIS_SDL2
 
 #define SDL_MAIN_HANDLED
@@ -12,7 +15,9 @@
 
 // #include <SDL.h>
 #include <openacc.h>
+#include <memory>
 #include <random>
+#include <sstream>
 #include <vector>
 
 #include "systems/types.h"
@@ -24,6 +29,8 @@
 
 #include "systems/update_state.h"
 #include "systems/run_benchmarks.h"
+#include "systems/sweep_config.h"
+#include "systems/world_io.h"
 #include "systems/json.h"
 
 // only define visualizations if VIS_SDL2 is defined
@@ -36,23 +43,42 @@ constexpr int CELL_SIZE = 4;
 
 // this function will run a simple SDL2 preview of the cellular automaton.
 // only used for initial debugging and visualization. this is not used in the benchmarking.
-void preview() {
-  // test render_state
-
+// if file is not empty, the preview starts from it instead of a random world.
+// pressing S saves a checkpoint of the current state to preview.caw. the arrow keys or dragging
+// with the mouse pan the view, +/- or the mouse wheel zoom, D switches between showing any living
+// cell and the density of living cells when zoomed out, and F fits the whole world again.
+void preview(const std::string &file) {
   // initialize SDL
   SDL_Init(SDL_INIT_VIDEO);
   SDL_Window *window = SDL_CreateWindow("Cellular Automaton", SDL_WINDOWPOS_CENTERED,
-                                        SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, 0);
+                                        SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT,
+                                        SDL_WINDOW_RESIZABLE);
   SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
 
-  // initalize world with random state
+  // initalize world with random state, or from the file
   std::random_device rd;
   std::mt19937 gen(rd());
   ca::World world_write(SCREEN_WIDTH / CELL_SIZE, SCREEN_HEIGHT / CELL_SIZE, gen);
+  ca::Rule rule = ca::CONWAY;
+  std::uint64_t generation = 0;
+  if (!file.empty()) {
+    ca::LoadedWorld loaded = ca::load_world(file, world_write.width, world_write.height);
+    world_write = loaded.world;
+    if (loaded.has_rule) rule = loaded.rule;
+    generation = loaded.generation;
+  }
 
   // define second buffer, copy to maintain width, height, state size
   ca::World world_read = world_write;
 
+  ca::ThreadPool pool(0, false);
+  ca::StreamingRenderer streaming(renderer, &pool);
+  auto fit = [&] {
+    return ca::fit_viewport(world_write.width, world_write.height, streaming.width(),
+                            streaming.height());
+  };
+  ca::Viewport view = fit();
+
   // setup the render loop
   bool running = true;
   SDL_Event event;
@@ -60,17 +86,45 @@ void preview() {
     while (SDL_PollEvent(&event)) {
       if (event.type == SDL_QUIT) {
         running = false;
+      } else if (event.type == SDL_KEYDOWN) {
+        // pan by a tenth of the window
+        const double step = streaming.width() / 10.0;
+        switch (event.key.keysym.sym) {
+        case SDLK_s:
+          ca::save_checkpoint("preview.caw", ca::BitWorld(world_write), rule, generation, true);
+          std::cout << "Saved generation " << generation << " to preview.caw" << std::endl;
+          break;
+        case SDLK_LEFT: view.pan(-step, 0); break;
+        case SDLK_RIGHT: view.pan(step, 0); break;
+        case SDLK_UP: view.pan(0, -step); break;
+        case SDLK_DOWN: view.pan(0, step); break;
+        case SDLK_PLUS:
+        case SDLK_EQUALS: view.zoom *= 1.25; break;
+        case SDLK_MINUS: view.zoom /= 1.25; break;
+        case SDLK_d:
+          view.pooling =
+              view.pooling == ca::Pooling::MAX ? ca::Pooling::DENSITY : ca::Pooling::MAX;
+          break;
+        case SDLK_f: view = fit(); break;
+        default: break;
+        }
+      } else if (event.type == SDL_MOUSEWHEEL) {
+        view.zoom *= event.wheel.y > 0 ? 1.25 : 0.8;
+      } else if (event.type == SDL_MOUSEMOTION && (event.motion.state & SDL_BUTTON_LMASK)) {
+        // the world follows the mouse
+        view.pan(-event.motion.xrel, -event.motion.yrel);
       }
     }
 
     // render the state
-    ca::render_state(world_write, renderer, window);
+    streaming.draw(world_write, view);
 
     // swap the world buffers
     std::swap(world_read.state, world_write.state);
 
     // update the state
-    ca::update_state(world_read, world_write);
+    ca::update_state(world_read, world_write, rule);
+    generation++;
 
     // present the renderer
     SDL_RenderPresent(renderer);
@@ -79,55 +133,100 @@ void preview() {
 
 #endif
 
-void sweep_params() {
+// the sweeps that are run when none are given on the command line (see sweep_config.h)
+constexpr const char *DEFAULT_SWEEPS = R"(
+# various world sizes. shorten iterations because we will do multiple runs
+sweep width_height=128:4096:128
+set iterations=64
+set num_jobs=4
+output change_width_height.json
+
+# various iterations
+sweep iterations=2:64:2
+set num_jobs=4
+output change_iters.json
+
+# very long iteration counts. only HashLife can reach these in reasonable time,
+# so run it alone, alongside the bit-packed engine to validate its results.
+sweep iterations=1024:1048576:x2
+set width_height=256
+set num_jobs=2
+benchmarks cpu_hashlife,cpu_bit_packed
+output change_long_iters.json
+
+# other life-like rules
+sweep rule=B3/S23,B36/S23,B3678/S34678,B2/S
+set iterations=64
+set num_jobs=4
+output change_rule.json
+
+# pattern growth on the unbounded engine. a small soup in the center of a large world
+# does not reach the edges in time, so the fixed-size engines still validate the results.
+sweep iterations=64:1024:x2
+set width_height=2048
+set soup_size=64
+set num_jobs=2
+benchmarks cpu_sparse,cpu_active_tiles,cpu_bit_packed
+output change_growth.json
+)";
+
+// returns the number of validation failures over all sweeps
+int sweep_params(SweepPlan plan) {
   if (acc_get_device_type() != acc_device_nvidia) {
     std::cerr << "No GPU device found" << std::endl;
   }
 
-  std::vector<ParameterBenchmarkSet> benchmark_sets;
-
-  // Explore width_height parameter
-  std::cout << "Exploring various world sizes..." << std::endl;
-  // try 32 different sizes
-  for (int i = 0; i < 32; ++i) {
-    // set up the parameters for the benchmark
-    BenchmarkParams params;
-    params.iterations >>= 3;  // shorten iterations because we will do multiple runs
-    params.width_height = (i + 1) * 128;  // step through the width_height param
-    params.num_jobs = 1 << 2;
-    // run the benchmarks for this parameter set
-    benchmark_sets.push_back(run_benchmarks(params));
+  // fall back to the default sweeps. parameters set on the command line win over the settings
+  // of the default sweeps.
+  if (plan.sweeps.empty()) {
+    std::istringstream defaults(DEFAULT_SWEEPS);
+    plan.read_config(defaults);
+    plan.reapply_default_settings();
   }
 
-  // Create and write the width_height sweep
-  ParameterSweep("width_height", benchmark_sets).write_to_json("change_width_height.json");
-
-  // Clear for next sweep
-  benchmark_sets.clear();
-
-  // Explore iterations parameter
-  std::cout << "Exploring various iterations..." << std::endl;
-  // try 32 different sizes (increment by 2)
-  for (int i = 2; i <= 64; i += 2) {
-    // set up the parameters for the benchmark
-    BenchmarkParams params;
-    params.iterations = i;
-    params.num_jobs = 1 << 2;
-    // run the benchmarks for this parameter set
-    benchmark_sets.push_back(run_benchmarks(params));
+  int validation_failures = 0;
+  for (const auto &sweep : plan.sweeps) {
+    validation_failures += run_sweep(sweep);
   }
+  return validation_failures;
+}
 
-  // Create and write the iterations sweep
-  ParameterSweep("iterations", benchmark_sets).write_to_json("change_iters.json");
+// run the benchmarks once, starting from a file, instead of sweeping. returns the number of
+// validation failures.
+int run_from_file(const BenchmarkParams &params) {
+  std::vector<ParameterBenchmarkSet> benchmark_sets;
+  benchmark_sets.push_back(run_benchmarks(params));
+  const int validation_failures = benchmark_sets.back().validation_failures;
+  ParameterSweep("initial_state_file", std::move(benchmark_sets)).write_to_json("from_file.json");
+  return validation_failures;
 }
 
 int main(int argc, char *argv[]) {
+  // parse the sweeps and the optional initial state file
+  bool show_help = false;
+  SweepPlan plan;
+  try {
+    plan = parse_command_line(argc, argv, show_help);
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  if (show_help) {
+    return 0;
+  }
+  const std::string &file = plan.defaults.initial_state_file;
   // if VIS_SDL2 is defined, run the preview function
   // otherwise, run the parameter sweep function
   #ifdef VIS_SDL2
-  preview();
+  preview(file);
   #else
-  sweep_params();
+  const int validation_failures =
+      !file.empty() && plan.sweeps.empty() ? run_from_file(plan.defaults) : sweep_params(plan);
+  // a broken engine fails the run, after its results have been written
+  if (validation_failures > 0) {
+    std::cerr << validation_failures << " validation failure(s)" << std::endl;
+    return 1;
+  }
   #endif
   return 0;
 }
@@ -0,0 +1,405 @@
+// Microbenchmarks of the individual kernels, built as a separate binary by `make bench`.
+// Each kernel is timed in isolation at fixed world sizes and reported in cells per nanosecond,
+// along with the bytes it moves per cell. The results are compared against a baseline file, and
+// the program exits with an error if any kernel got slower than the baseline by more than the
+// threshold, so that `make bench` fails on a regression.
+//
+// usage: microbench [--baseline <file>] [--update-baseline] [--threshold <fraction>]
+//                   [--output <file>]
+// the baseline defaults to microbench_<hostname>.baseline in the working directory. a missing
+// baseline is an error, so that a checkout without one cannot pass: record it on a known-good
+// build with --update-baseline (`make bench-baseline`).
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "systems/bit_world.h"
+#include "systems/halo_world.h"
+#include "systems/random_world.h"
+#include "systems/rule.h"
+#include "systems/sized_kernels.h"
+#include "systems/sliced_world.h"
+#include "systems/state_hash.h"
+#include "systems/tuning_cache.h"
+#include "systems/types.h"
+#include "systems/update_state.h"
+
+namespace {
+// world edge lengths every kernel is timed at: one that fits in cache, one that does not
+constexpr int BENCH_SIZES[] = {256, 2048};
+// a kernel is called until a sample takes at least this long, and the fastest of the samples
+// is kept, which is the least disturbed by the rest of the machine
+constexpr double MIN_SAMPLE_SECONDS = 0.02;
+constexpr int SAMPLES = 7;
+// sizes with a regression are measured again this many times, keeping each kernel's best, before
+// the regression is reported. a slow phase of the machine rarely lasts through all of them.
+constexpr int RECHECKS = 2;
+// default slowdown (as a fraction of the baseline's cells/ns) that counts as a regression
+constexpr double THRESHOLD = 0.15;
+constexpr const char *BASELINE_MAGIC = "# cellular automata microbenchmark baseline v1";
+
+// one kernel at one size
+struct Measurement {
+  std::string kernel;
+  int size{0};
+  // cells processed per nanosecond, and bytes read and written per cell
+  double cells_per_ns{0};
+  double bytes_per_cell{0};
+
+  std::string key() const { return kernel + "@" + std::to_string(size); }
+
+  std::string to_json() const {
+    std::stringstream ss;
+    ss << "{";
+    ss << "\"kernel\": \"" << kernel << "\",";
+    ss << "\"size\": " << size << ",";
+    ss << "\"cells_per_ns\": " << cells_per_ns << ",";
+    ss << "\"bytes_per_cell\": " << bytes_per_cell;
+    ss << "}";
+    return ss.str();
+  }
+};
+
+// seconds per call of the kernel: the fastest of SAMPLES samples, each calling it often enough
+// to take at least MIN_SAMPLE_SECONDS
+double time_kernel(const std::function<void()> &kernel) {
+  auto sample = [&](long calls) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (long i = 0; i < calls; ++i) {
+      kernel();
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time)
+        .count();
+  };
+  // warm up, then find the number of calls per sample
+  kernel();
+  long calls = 1;
+  double seconds = sample(calls);
+  while (seconds < MIN_SAMPLE_SECONDS) {
+    calls *= 2;
+    seconds = sample(calls);
+  }
+  double best = seconds / calls;
+  for (int s = 1; s < SAMPLES; ++s) {
+    best = std::min(best, sample(calls) / calls);
+  }
+  return best;
+}
+
+// the neighbor counts of every cell of a bit-packed world, as four bit-planes, so that counting
+// and applying the rule can be timed separately. the fused kernels never store them.
+struct CountPlanes {
+  std::vector<ca::word_t> ones, twos, fours, eights;
+
+  explicit CountPlanes(size_t words) : ones(words), twos(words), fours(words), eights(words) {}
+};
+
+// count the neighbors of every cell. the width must be a multiple of the word size.
+void count_planes(const ca::BitWorld &world, CountPlanes &planes) {
+  const int words = world.words_per_row;
+  for (int y = 0; y < world.height; ++y) {
+    const ca::word_t *rows[3] = {
+        &world.words[static_cast<size_t>((y + world.height - 1) % world.height) * words],
+        &world.words[static_cast<size_t>(y) * words],
+        &world.words[static_cast<size_t>((y + 1) % world.height) * words]};
+    for (int w = 0; w < words; ++w) {
+      const int west_word = w == 0 ? words - 1 : w - 1;
+      const int east_word = w + 1 == words ? 0 : w + 1;
+      // each row's cells shifted by one towards the east and towards the west
+      ca::word_t west[3], center[3], east[3];
+      for (int r = 0; r < 3; ++r) {
+        center[r] = rows[r][w];
+        west[r] = (center[r] << 1) | (rows[r][west_word] >> (ca::CELLS_PER_WORD - 1));
+        east[r] = (center[r] >> 1) | (rows[r][east_word] << (ca::CELLS_PER_WORD - 1));
+      }
+      const ca::NeighborCount count = ca::count_neighbors(
+          west[0], center[0], east[0], west[1], east[1], west[2], center[2], east[2]);
+      const size_t i = static_cast<size_t>(y) * words + w;
+      planes.ones[i] = count.ones;
+      planes.twos[i] = count.twos;
+      planes.fours[i] = count.fours;
+      planes.eights[i] = count.eights;
+    }
+  }
+}
+
+// apply a rule to stored neighbor counts, branch-free like ca::DynamicRuleKernel
+void apply_rule(const ca::BitWorld &read, const CountPlanes &planes, ca::Rule rule,
+                ca::BitWorld &write) {
+  ca::word_t birth_masks[9], survival_masks[9];
+  for (int k = 0; k <= 8; ++k) {
+    birth_masks[k] = ((rule.birth >> k) & 1) ? ~ca::word_t{0} : 0;
+    survival_masks[k] = ((rule.survival >> k) & 1) ? ~ca::word_t{0} : 0;
+  }
+  const size_t size = read.words.size();
+  for (size_t i = 0; i < size; ++i) {
+    const ca::NeighborCount count{planes.ones[i], planes.twos[i], planes.fours[i],
+                                  planes.eights[i]};
+    const ca::word_t c = read.words[i];
+    ca::word_t next = 0;
+    for (int k = 0; k <= 8; ++k) {
+      next |= count.equals(k) & ((birth_masks[k] & ~c) | (survival_masks[k] & c));
+    }
+    write.words[i] = next;
+  }
+}
+
+// time every kernel at one size
+std::vector<Measurement> measure(int size) {
+  const ca::Rule rule = ca::CONWAY;
+  const double cells = static_cast<double>(size) * size;
+  std::vector<Measurement> measurements;
+  auto add = [&](const std::string &kernel, double cells_per_call, double bytes_per_cell,
+                 const std::function<void()> &run) {
+    const double seconds = time_kernel(run);
+    measurements.push_back({kernel, size, cells_per_call / (seconds * 1e9), bytes_per_cell});
+    const Measurement &m = measurements.back();
+    std::cout << std::left << std::setw(20) << kernel << std::right << std::setw(6) << size
+              << std::fixed << std::setprecision(3) << std::setw(12) << m.cells_per_ns
+              << std::setw(10) << m.bytes_per_cell << std::setw(10)
+              << m.cells_per_ns * m.bytes_per_cell << std::defaultfloat << std::endl;
+  };
+
+  // the step kernels read one buffer and write the other, without swapping, so every call does
+  // the same work
+  const ca::World world = ca::random_world(size, size, ca::DENSITY, 1);
+  ca::World world_out(size, size);
+  const ca::BitWorld bits(world);
+  ca::BitWorld bits_out(size, size);
+  const ca::HaloWorld halo(world);
+  ca::HaloWorld halo_out(world);
+  ca::SlicedWorld sliced(size, size);
+  for (int k = 0; k < ca::WORLDS_PER_SLICE; ++k) {
+    sliced.pack(ca::random_world(size, size, ca::DENSITY, 1, k), k);
+  }
+  ca::SlicedWorld sliced_out(size, size);
+  CountPlanes planes(bits.words.size());
+
+  // counting and applying the rule separately must give the fused kernel's result
+  count_planes(bits, planes);
+  apply_rule(bits, planes, rule, bits_out);
+  ca::BitWorld expected(size, size);
+  ca::update_bit_state(bits, expected, rule);
+  if (bits_out.words != expected.words) {
+    throw std::logic_error("split neighbor count and rule do not match update_bit_state");
+  }
+
+  // bytes per cell: what each kernel streams through memory, one bit per cell for the packed
+  // and sliced layouts and one byte per cell for the others
+  add("neighbor_count", cells, 1.0 / 8 + 4.0 / 8, [&] { count_planes(bits, planes); });
+  add("rule_apply", cells, 5.0 / 8 + 1.0 / 8, [&] { apply_rule(bits, planes, rule, bits_out); });
+  add("bit_packed_step", cells, 2.0 / 8,
+      [&] { ca::update_bit_state(bits, bits_out, rule); });
+  add("sliced_step", cells * ca::WORLDS_PER_SLICE, 2.0 / 8,
+      [&] { ca::update_sliced_state(sliced, sliced_out, rule); });
+  add("sized_step", cells, 2, [&] {
+    ca::with_size_policy(size, size, [&](auto policy) {
+      ca::update_state_sized(world, world_out, rule, policy);
+    });
+  });
+  add("halo_step", cells, 2, [&] { ca::update_halo_state(halo, halo_out, rule); });
+  add("naive_step", cells, 2, [&] { ca::update_state(world, world_out, rule); });
+  // the ghost cells are a thin ring, so per cell of the world this is cheap
+  add("halo_refresh", cells, 2.0 * (2.0 * size + 2.0 * size + 4) / cells,
+      [&] { halo_out.refresh_halo(); });
+  add("world_generation", cells, 1, [&] {
+    ca::World generated = ca::random_world(size, size, ca::DENSITY, 2);
+    (void)generated;
+  });
+  add("digest_bytes", cells, 1, [&] { (void)ca::state_digest(world); });
+  add("digest_bits", cells, 1.0 / 8, [&] { (void)ca::state_digest(bits); });
+  return measurements;
+}
+
+std::string default_baseline_path() {
+  std::string name = ca::host_name();
+  for (char &c : name) {
+    if (c == '/' || c == '\\' || c == ' ') c = '_';
+  }
+  return "microbench_" + name + ".baseline";
+}
+
+// cells/ns of every kernel@size in a baseline file. empty if the file does not exist.
+std::map<std::string, double> read_baseline(const std::string &path) {
+  std::map<std::string, double> baseline;
+  std::ifstream in(path);
+  if (!in.is_open()) return baseline;
+  std::string line;
+  if (!std::getline(in, line) || line != BASELINE_MAGIC) {
+    throw std::runtime_error(path + " is not a microbenchmark baseline");
+  }
+  std::string keyword, host;
+  if (!std::getline(in, line) || !(std::istringstream(line) >> keyword >> host) ||
+      keyword != "host") {
+    throw std::runtime_error("missing host in baseline " + path);
+  }
+  if (host != ca::host_name()) {
+    std::cerr << "Warning: " << path << " was recorded on " << host << ", this is "
+              << ca::host_name() << std::endl;
+  }
+  // kernel size cells_per_ns bytes_per_cell
+  for (int number = 3; std::getline(in, line); ++number) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream fields(line);
+    Measurement m;
+    if (!(fields >> m.kernel >> m.size >> m.cells_per_ns)) {
+      throw std::runtime_error("invalid measurement on line " + std::to_string(number) + " of " +
+                               path);
+    }
+    baseline[m.key()] = m.cells_per_ns;
+  }
+  return baseline;
+}
+
+void write_baseline(const std::string &path, const std::vector<Measurement> &measurements) {
+  std::ofstream out(path);
+  if (!out.is_open()) {
+    throw std::runtime_error("Failed to open file: " + path);
+  }
+  out << BASELINE_MAGIC << "\n";
+  out << "host " << ca::host_name() << "\n";
+  out << "# kernel size cells_per_ns bytes_per_cell\n";
+  out.precision(6);
+  for (const auto &m : measurements) {
+    out << m.kernel << " " << m.size << " " << m.cells_per_ns << " " << m.bytes_per_cell << "\n";
+  }
+}
+
+// the measurements slower than their baseline by more than threshold
+std::vector<const Measurement *> find_regressions(const std::vector<Measurement> &measurements,
+                                                 const std::map<std::string, double> &baseline,
+                                                 double threshold) {
+  std::vector<const Measurement *> regressions;
+  for (const auto &m : measurements) {
+    const auto found = baseline.find(m.key());
+    if (found != baseline.end() && m.cells_per_ns < found->second * (1 - threshold)) {
+      regressions.push_back(&m);
+    }
+  }
+  return regressions;
+}
+
+void write_json(const std::string &path, const std::vector<Measurement> &measurements) {
+  std::ofstream out(path);
+  if (!out.is_open()) {
+    throw std::runtime_error("Failed to open file: " + path);
+  }
+  out << "{\n  \"host\": \"" << ca::host_name() << "\",\n  \"measurements\": [";
+  for (size_t i = 0; i < measurements.size(); ++i) {
+    if (i > 0) out << ",";
+    out << "\n    " << measurements[i].to_json();
+  }
+  out << "\n  ]\n}\n";
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string baseline_path = default_baseline_path();
+  std::string output;
+  bool update_baseline = false;
+  double threshold = THRESHOLD;
+  try {
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (arg == "--update-baseline") {
+        update_baseline = true;
+      } else if ((arg == "--baseline" || arg == "--threshold" || arg == "--output") &&
+                 i + 1 < argc) {
+        const std::string value = argv[++i];
+        if (arg == "--baseline") baseline_path = value;
+        if (arg == "--output") output = value;
+        if (arg == "--threshold") threshold = std::stod(value);
+      } else {
+        std::cerr << "usage: " << argv[0] << " [--baseline <file>] [--update-baseline] "
+                  << "[--threshold <fraction>] [--output <file>]" << std::endl;
+        return 2;
+      }
+    }
+
+    const std::map<std::string, double> baseline = read_baseline(baseline_path);
+    if (baseline.empty() && !update_baseline) {
+      std::cerr << "No baseline in " << baseline_path << ": record one on a known-good build "
+                << "with --update-baseline (make bench-baseline)" << std::endl;
+      return 1;
+    }
+
+    std::cout << std::left << std::setw(20) << "kernel" << std::right << std::setw(6) << "size"
+              << std::setw(12) << "cells/ns" << std::setw(10) << "B/cell" << std::setw(10)
+              << "GB/s" << std::endl;
+    std::vector<Measurement> measurements;
+    for (int size : BENCH_SIZES) {
+      for (auto &m : measure(size)) {
+        measurements.push_back(std::move(m));
+      }
+    }
+    if (!update_baseline) {
+      for (int recheck = 0; recheck < RECHECKS; ++recheck) {
+        const auto regressions = find_regressions(measurements, baseline, threshold);
+        if (regressions.empty()) break;
+        std::vector<int> sizes;
+        for (const Measurement *m : regressions) {
+          if (std::find(sizes.begin(), sizes.end(), m->size) == sizes.end()) {
+            sizes.push_back(m->size);
+          }
+        }
+        std::cout << "Rechecking " << regressions.size() << " slower kernel(s)..." << std::endl;
+        for (int size : sizes) {
+          for (const auto &again : measure(size)) {
+            for (auto &m : measurements) {
+              if (m.key() == again.key()) {
+                m.cells_per_ns = std::max(m.cells_per_ns, again.cells_per_ns);
+              }
+            }
+          }
+        }
+      }
+    }
+    if (!output.empty()) {
+      write_json(output, measurements);
+      std::cout << "Wrote " << output << std::endl;
+    }
+
+    if (update_baseline) {
+      write_baseline(baseline_path, measurements);
+      std::cout << "Wrote baseline " << baseline_path << std::endl;
+      return 0;
+    }
+
+    // compare against the baseline
+    for (const auto &m : measurements) {
+      if (baseline.find(m.key()) == baseline.end()) {
+        std::cout << "New kernel " << m.key() << " (not in the baseline)" << std::endl;
+      }
+    }
+    const auto regressions = find_regressions(measurements, baseline, threshold);
+    for (const Measurement *m : regressions) {
+      const double before = baseline.at(m->key());
+      std::cerr << "REGRESSION: " << m->key() << " dropped " << std::fixed << std::setprecision(1)
+                << (1 - m->cells_per_ns / before) * 100 << "% (" << std::setprecision(3)
+                << before << " -> " << m->cells_per_ns << " cells/ns)" << std::defaultfloat
+                << std::endl;
+    }
+    if (!regressions.empty()) {
+      std::cerr << regressions.size() << " kernel(s) regressed by more than " << threshold * 100
+                << "% against " << baseline_path
+                << " (rerun with --update-baseline to accept the new numbers)" << std::endl;
+      return 1;
+    }
+    std::cout << "No regressions against " << baseline_path << " (threshold " << threshold * 100
+              << "%)" << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 2;
+  }
+  return 0;
+}
@@ -0,0 +1,53 @@
+// Defines a tiled CPU engine for bit-packed worlds that only recomputes tiles whose
+// neighborhood changed recently. Random soups settle into mostly still-lifes and period 2
+// oscillators (blinkers), so most tiles can be skipped after a few hundred generations.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "bit_world.h"
+#include "types.h"
+
+namespace ca {
+
+// default tile edge length in cells (rounded up to a whole number of words horizontally)
+constexpr int ACTIVE_TILE_SIZE = 64;
+
+class ActiveTileWorld {
+public:
+  ActiveTileWorld(const World &world, int tile_size, Rule rule);
+
+  // advance one generation. returns the fraction of tiles that were recomputed.
+  double step();
+
+  World to_world() const { return read.to_world(); }
+  // the current generation
+  const BitWorld &state() const { return read; }
+
+  unsigned long get_mem_size() const {
+    return read.get_mem_size() + write.get_mem_size() + 2 * changed.size() +
+           previous.size() * sizeof(word_t);
+  }
+
+private:
+  // both buffers hold a valid generation: read the current one (t), write the previous one (t-1).
+  // if a tile's neighborhood is the same at t as at t-2, then its next state is the same as at
+  // t-1, which is already in write. this skips still-lifes and period 2 oscillators alike.
+  BitWorld read;
+  BitWorld write;
+  Rule rule;
+  int tile_rows;
+  int tile_words;
+  int tiles_x;
+  int tiles_y;
+  int generation{0};
+  // per-tile flag: does the tile differ from two generations ago?
+  std::vector<std::uint8_t> changed;
+  // scratch copy of the tile being recomputed, as it was two generations ago
+  std::vector<word_t> previous;
+  // per-tile flag: does the tile (or any of its 8 neighbors) need recomputing?
+  std::vector<std::uint8_t> dirty;
+};
+
+} // namespace ca
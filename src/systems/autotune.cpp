@@ -0,0 +1,175 @@
+// Defines the autotuner, which times short trial runs of every engine configuration worth trying
+// (engine, tile size, generations per block, thread count) through run_benchmarks, and keeps the
+// fastest for each world size and generation count in this host's tuning cache. The "auto"
+// benchmark then runs each job with the configuration tuned closest to it.
+#include "autotune.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include "thread_pool.h"
+
+namespace {
+// tile edge lengths and generations per block tried for the tiled engines
+constexpr int TUNE_TILE_SIZES[] = {64, 128, 256, 512};
+constexpr int TUNE_TILE_GENERATIONS[] = {2, 4, 8, 16};
+
+std::string cache_path(const BenchmarkParams &params) {
+  return params.tuning_cache.empty() ? ca::TuningCache::default_path() : params.tuning_cache;
+}
+
+// whether the time a configuration takes per generation depends on how many generations it runs,
+// so that a short trial cannot be extrapolated. hashlife caches results and skips ahead in
+// time, which only pays off over long runs.
+bool needs_full_length_trial(const ca::TunedConfig &config) {
+  return config.benchmark == "cpu_hashlife";
+}
+} // namespace
+
+std::vector<ca::TunedConfig> tuning_candidates(int width_height, int max_threads) {
+  std::vector<ca::TunedConfig> candidates;
+  auto add = [&](const std::string &benchmark, int tile_size, int tile_generations,
+                 int num_threads) {
+    ca::TunedConfig config;
+    config.benchmark = benchmark;
+    config.tile_size = tile_size;
+    config.tile_generations = tile_generations;
+    config.num_threads = num_threads;
+    candidates.push_back(config);
+  };
+  // the first candidate is the reference the others are validated against
+  add("cpu_bit_packed", 0, 0, 0);
+  add("cpu_sized", 0, 0, 0);
+  add("cpu_halo", 0, 0, 0);
+  add("cpu_hashlife", 0, 0, 0);
+  for (int tile_size : TUNE_TILE_SIZES) {
+    // the smallest tile is always tried
+    if (tile_size > width_height && tile_size != TUNE_TILE_SIZES[0]) continue;
+    for (int tile_generations : TUNE_TILE_GENERATIONS) {
+      add("cpu_temporal", tile_size, tile_generations, 0);
+    }
+    add("cpu_active_tiles", tile_size, 0, 0);
+  }
+  for (int threads = 2; threads < max_threads; threads *= 2) {
+    add("cpu_parallel", 0, 0, threads);
+  }
+  if (max_threads > 1) add("cpu_parallel", 0, 0, max_threads);
+  return candidates;
+}
+
+std::unique_ptr<Benchmark> make_configured_benchmark(const ca::TunedConfig &config,
+                                                     const BenchmarkParams &params) {
+  // make_benchmarks would expand cpu_parallel to every thread count
+  if (config.benchmark == "cpu_parallel") {
+    return std::make_unique<CPUParallel>(std::max(config.num_threads, 1), params.pin_threads);
+  }
+  BenchmarkParams configured = params;
+  if (config.tile_size > 0) {
+    configured.tile_size = config.tile_size;
+    configured.active_tile_size = config.tile_size;
+  }
+  if (config.tile_generations > 0) configured.tile_generations = config.tile_generations;
+  return std::move(make_benchmarks(configured, {config.benchmark}).front());
+}
+
+std::unique_ptr<Benchmark> make_auto_benchmark(const BenchmarkParams &params) {
+  const std::string path = cache_path(params);
+  ca::TuningCache cache = ca::TuningCache::load(path);
+  if (cache.empty()) {
+    std::cerr << "No tuned configurations in " << path
+              << ", auto runs cpu_bit_packed (tune with --set autotune=true)" << std::endl;
+    ca::TunedConfig fallback;
+    fallback.benchmark = "cpu_bit_packed";
+    cache.insert(fallback);
+  }
+  std::vector<std::unique_ptr<Benchmark>> engines;
+  for (const auto &config : cache.configs()) {
+    engines.push_back(make_configured_benchmark(config, params));
+  }
+  return std::make_unique<CPUAuto>(std::move(cache), std::move(engines));
+}
+
+ParameterBenchmarkSet autotune(BenchmarkParams params) {
+  const int max_threads = params.num_threads > 0 ? params.num_threads : ca::hardware_threads();
+  const std::vector<ca::TunedConfig> candidates =
+      tuning_candidates(params.width_height, max_threads);
+
+  // short trial runs, one job at a time, without anything that would slow the engines down
+  BenchmarkParams trial = params;
+  trial.iterations = std::max(1, std::min(params.iterations, params.tune_iterations));
+  trial.job_threads = 1;
+  trial.check_golden = false;
+  trial.perf_counters = false;
+  trial.trace_every = 0;
+  trial.record_every = 0;
+  trial.render_every = 0;
+  trial.cycle_mode = ca::CycleMode::OFF;
+  std::vector<std::unique_ptr<Benchmark>> benchmarks;
+  for (const auto &candidate : candidates) {
+    benchmarks.push_back(make_configured_benchmark(candidate, trial));
+  }
+  std::cout << "Tuning " << params.width_height << "x" << params.width_height << ", "
+            << params.iterations << " generations: " << candidates.size()
+            << " configurations of " << trial.iterations << " generations each..." << std::endl;
+  ParameterBenchmarkSet trials = run_benchmarks(trial, std::move(benchmarks));
+
+  // estimated time of a whole run of params.iterations generations for every candidate:
+  // the trial time scaled up, or a trial at full length for those that do not scale linearly
+  std::vector<double> run_seconds(candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    run_seconds[i] = trials.benchmark_types[i].stats.median / trial.iterations * params.iterations;
+  }
+  if (params.iterations > trial.iterations) {
+    BenchmarkParams full = trial;
+    full.iterations = params.iterations;
+    std::vector<size_t> timed;
+    std::vector<std::unique_ptr<Benchmark>> full_benchmarks;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      if (!needs_full_length_trial(candidates[i])) continue;
+      timed.push_back(i);
+      full_benchmarks.push_back(make_configured_benchmark(candidates[i], full));
+    }
+    if (!timed.empty()) {
+      std::cout << "Timing " << timed.size() << " configurations over all " << full.iterations
+                << " generations..." << std::endl;
+      const ParameterBenchmarkSet full_trials = run_benchmarks(full, std::move(full_benchmarks));
+      for (size_t k = 0; k < timed.size(); ++k) {
+        run_seconds[timed[k]] = full_trials.benchmark_types[k].stats.median;
+      }
+    }
+  }
+
+  // the fastest candidate that computed the same states as the reference in the short trial
+  const auto &reference = trials.benchmark_types.front().results;
+  int best = -1;
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    const auto &type = trials.benchmark_types[i];
+    bool valid = type.results.size() == reference.size();
+    for (size_t j = 0; valid && j < reference.size(); ++j) {
+      valid = type.results[j].digest == reference[j].digest;
+    }
+    if (!valid) {
+      std::cerr << "Not tuning for " << candidates[i].describe() << ": its results differ"
+                << std::endl;
+      continue;
+    }
+    if (best < 0 || run_seconds[i] < run_seconds[best]) best = static_cast<int>(i);
+  }
+
+  ca::TunedConfig winner = candidates[best];
+  winner.width_height = params.width_height;
+  winner.iterations = params.iterations;
+  winner.seconds_per_generation = run_seconds[best] / params.iterations;
+  std::cout << "Fastest for " << params.width_height << "x" << params.width_height << ", "
+            << params.iterations << " generations: " << winner.describe() << " ("
+            << winner.seconds_per_generation << " s per generation)" << std::endl;
+
+  // merge into the cache on disk, so sweeps over several sizes fill it in one point at a time
+  const std::string path = cache_path(params);
+  ca::TuningCache cache = ca::TuningCache::load(path);
+  cache.insert(winner);
+  cache.save(path);
+  std::cout << "Wrote " << path << std::endl;
+  return trials;
+}
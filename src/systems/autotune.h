@@ -0,0 +1,43 @@
+// Defines the autotuner, which times short trial runs of every engine configuration worth trying
+// (engine, tile size, generations per block, thread count) through run_benchmarks, and keeps the
+// fastest for each world size and generation count in this host's tuning cache. The "auto"
+// benchmark then runs each job with the configuration tuned closest to it.
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "benchmark.h"
+#include "run_benchmarks.h"
+#include "tuning_cache.h"
+
+/**
+ * @brief the configurations tried for a world size
+ *
+ * @param width_height world edge length. tiles larger than the world are left out.
+ * @param max_threads the multithreaded engine is tried at every power of two from 2 up to this,
+ * and at this count
+ */
+std::vector<ca::TunedConfig> tuning_candidates(int width_height, int max_threads);
+
+// create the benchmark that runs a configuration, taking every other setting from params.
+// throws std::invalid_argument for unknown benchmarks.
+std::unique_ptr<Benchmark> make_configured_benchmark(const ca::TunedConfig &config,
+                                                     const BenchmarkParams &params);
+
+// create the "auto" benchmark from params.tuning_cache (this host's cache if empty). without any
+// tuned configuration it runs cpu_bit_packed.
+std::unique_ptr<Benchmark> make_auto_benchmark(const BenchmarkParams &params);
+
+/**
+ * @brief tune params.width_height and params.iterations, and store the winner in the cache
+ *
+ * every candidate runs the jobs of params for at most params.tune_iterations generations, and
+ * its time is scaled up to params.iterations generations. engines whose time per generation
+ * falls over long runs (hashlife) are also timed over all params.iterations generations, since
+ * a short trial would undersell them. candidates whose final states in the short trial differ
+ * from the first one's are not picked.
+ *
+ * @return the trial runs of every candidate
+ */
+ParameterBenchmarkSet autotune(BenchmarkParams params);
@@ -2,29 +2,83 @@
 // generically, so that multiple benchmarks can share the same interface.
 #include "benchmark.h"
 
+#include <algorithm>
 #include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
 
 #include "types.h"
 #include "update_state.h"
+#include "sized_kernels.h"
+#include "sliced_world.h"
+#include "bit_world.h"
+#include "halo_world.h"
+#include "temporal_blocking.h"
+#include "hashlife.h"
+#include "active_tiles.h"
+#include "sparse_world.h"
+#include "live_cells.h"
+#include "domain_decomposition.h"
+#include "state_hash.h"
 
 
 JobResult CPUNaive::run(const Job &job) {
   // copy initial state
   ca::World read = job.initial_state;
-  ca::World write = job.initial_state;
+  ca::World write(read.width, read.height);
+  GenerationTracer tracer(job.trace_every, job.iterations);
+  std::unique_ptr<ca::SnapshotRecorder> recorder;
+  if (job.record_every > 0) {
+    recorder = std::make_unique<ca::SnapshotRecorder>(job.record_file, read.width, read.height,
+                                                      job.rule);
+  }
+  std::unique_ptr<ca::HeadlessRenderer> renderer;
+  if (job.render_every > 0) {
+    renderer = std::make_unique<ca::HeadlessRenderer>(job.render_size, job.render_file,
+                                                      read.width, read.height);
+  }
   auto start_time = std::chrono::high_resolution_clock::now();
+  tracer.start();
+  auto after_step = [&](int generation) {
+    tracer.record(generation);
+    if (recorder && generation % job.record_every == 0) recorder->record(read, generation);
+    if (renderer && generation % job.render_every == 0) renderer->render(read, generation);
+  };
+  ca::CycleInfo cycles;
   // run main computation
-  for (int i = 0; i < job.iterations; ++i) {
-    ca::update_state(read, write);
-    std::swap(read.state, write.state);
+  if (job.cycle_mode == ca::CycleMode::OFF) {
+    for (int i = 0; i < job.iterations; ++i) {
+      ca::update_state(read, write, job.rule);
+      std::swap(read.state, write.state);
+      after_step(i + 1);
+    }
+  } else {
+    auto step = [&] {
+      ca::StepStats stats = ca::update_state_counted(read, write, job.rule);
+      std::swap(read.state, write.state);
+      return stats;
+    };
+    cycles = ca::run_with_cycle_detection(job.iterations, job.cycle_mode, step, after_step);
   }
   auto end_time = std::chrono::high_resolution_clock::now();
 
   // Convert duration to double seconds
   auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
-  unsigned long mem_size = read.get_mem_size() + write.get_mem_size();
 
-  JobResult result(duration.count(), mem_size, read);
+  JobResult result(duration.count(), ca::state_digest(read));
+  result.trace = tracer.finish();
+  result.cycles = cycles;
+  if (recorder) {
+    // the snapshots still queued are written after the timed loop
+    result.recording = recorder->finish();
+    result.recording.overhead = result.recording.record_seconds / duration.count();
+  }
+  if (renderer) {
+    result.render = renderer->stats();
+    result.render.overhead =
+        (result.render.render_seconds + result.render.write_seconds) / duration.count();
+  }
   return result;
 }
 
@@ -32,23 +86,352 @@ std::string CPUNaive::get_description() {
   return "Fixed-size world running on CPU";
 }
 
+std::string CPUNaive::get_name() {
+  return "cpu_naive";
+}
+
+JobResult CPUSized::run(const Job &job) {
+  // copy initial state
+  ca::World read = job.initial_state;
+  ca::World write(read.width, read.height);
+  GenerationTracer tracer(job.trace_every, job.iterations);
+  // pick the kernel once, outside the timed loop
+  return ca::with_size_policy(read.width, read.height, [&](auto size) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    tracer.start();
+    // run main computation
+    for (int i = 0; i < job.iterations; ++i) {
+      ca::update_state_sized(read, write, job.rule, size);
+      std::swap(read.state, write.state);
+      tracer.record(i + 1);
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+
+    auto duration =
+        std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
+    JobResult result(duration.count(), ca::state_digest(read));
+    result.trace = tracer.finish();
+    result.kernel_variant = size.name();
+    return result;
+  });
+}
+
+std::string CPUSized::get_description() {
+  return "Fixed-size world running on CPU with size-specialized kernels";
+}
+
+std::string CPUSized::get_name() {
+  return "cpu_sized";
+}
+
+JobResult CPUHalo::run(const Job &job) {
+  // copy initial state into halo-padded buffers
+  ca::HaloWorld read(job.initial_state);
+  ca::HaloWorld write = read;
+  GenerationTracer tracer(job.trace_every, job.iterations);
+  auto start_time = std::chrono::high_resolution_clock::now();
+  tracer.start();
+  // run main computation
+  for (int i = 0; i < job.iterations; ++i) {
+    ca::update_halo_state(read, write, job.rule);
+    std::swap(read.state, write.state);
+    // wrap the edges once per generation instead of once per neighbor
+    read.refresh_halo();
+    tracer.record(i + 1);
+  }
+  auto end_time = std::chrono::high_resolution_clock::now();
+
+  auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
+
+  JobResult result(duration.count(), ca::state_digest(read.to_world()));
+  result.trace = tracer.finish();
+  return result;
+}
+
+std::string CPUHalo::get_description() {
+  return "Fixed-size halo-padded world running on CPU (" + ca::halo_kernel_isa() + ")";
+}
+
+std::string CPUHalo::get_name() {
+  return "cpu_halo";
+}
+
+CPUParallel::CPUParallel(int num_threads, bool pin_threads)
+    : pool(num_threads, pin_threads), pin_threads(pin_threads) {}
+
+JobResult CPUParallel::run(const Job &job) {
+  // pack initial state into bits
+  ca::BitWorld world_a(job.initial_state);
+  ca::BitWorld world_b(world_a.width, world_a.height);
+  const int num_threads = pool.size();
+  const int height = world_a.height;
+  ca::SpinBarrier barrier(num_threads);
+  GenerationTracer tracer(job.trace_every, job.iterations);
+
+  auto start_time = std::chrono::high_resolution_clock::now();
+  tracer.start();
+  pool.run([&](int thread_index) {
+    // each thread owns a contiguous band of rows
+    const int y_begin = static_cast<int>(static_cast<long>(height) * thread_index / num_threads);
+    const int y_end = static_cast<int>(static_cast<long>(height) * (thread_index + 1) / num_threads);
+    ca::BitWorld *read = &world_a;
+    ca::BitWorld *write = &world_b;
+    for (int i = 0; i < job.iterations; ++i) {
+      ca::update_bit_state(*read, *write, job.rule, y_begin, y_end);
+      // every band must be written before anyone reads the next generation
+      barrier.wait();
+      std::swap(read, write);
+      // the generation is complete once every thread passed the barrier
+      if (thread_index == 0) tracer.record(i + 1);
+    }
+  });
+  auto end_time = std::chrono::high_resolution_clock::now();
+
+  auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
+
+  // buffers swap every generation, so the result is in world_a after an even number of them
+  const ca::BitWorld &final_state = job.iterations % 2 == 0 ? world_a : world_b;
+  JobResult result(duration.count(), ca::state_digest(final_state, &pool));
+  result.trace = tracer.finish();
+  return result;
+}
+
+std::string CPUParallel::get_description() {
+  return "Fixed-size bit-packed world running on CPU with " + std::to_string(pool.size()) +
+         " threads" + (pin_threads ? " (pinned)" : "");
+}
+
+std::string CPUParallel::get_name() {
+  return "cpu_parallel";
+}
+
+int CPUParallel::get_num_threads() {
+  return pool.size();
+}
+
+CPUTemporal::CPUTemporal(int tile_size, int tile_generations)
+    : tile_size(tile_size), tile_generations(tile_generations) {
+  // run advances by tile_generations per pass, so it would never finish
+  if (tile_generations <= 0) {
+    throw std::invalid_argument("tile_generations must be positive, got " +
+                                std::to_string(tile_generations));
+  }
+}
+
+JobResult CPUTemporal::run(const Job &job) {
+  // pack initial state into bits
+  ca::BitWorld read(job.initial_state);
+  ca::BitWorld write(read.width, read.height);
+  GenerationTracer tracer(job.trace_every, job.iterations);
+  auto start_time = std::chrono::high_resolution_clock::now();
+  tracer.start();
+  // run main computation, tile_generations generations per pass over the world
+  for (int i = 0; i < job.iterations; i += tile_generations) {
+    int generations = std::min(tile_generations, job.iterations - i);
+    ca::update_bit_state_blocked(read, write, generations, tile_size, job.rule);
+    std::swap(read.words, write.words);
+    // generations complete a whole block at a time
+    tracer.record(i + generations);
+  }
+  auto end_time = std::chrono::high_resolution_clock::now();
+
+  auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
+
+  JobResult result(duration.count(), ca::state_digest(read));
+  result.trace = tracer.finish();
+  return result;
+}
+
+std::string CPUTemporal::get_description() {
+  return "Fixed-size bit-packed world running on CPU with temporal blocking (" +
+         std::to_string(tile_size) + " cell tiles, " + std::to_string(tile_generations) +
+         " generations per block)";
+}
+
+std::string CPUTemporal::get_name() {
+  return "cpu_temporal";
+}
+
+CPUHashLife::CPUHashLife(int memory_mb) : memory_mb(memory_mb) {}
+
+JobResult CPUHashLife::run(const Job &job) {
+  // import initial state
+  ca::HashLife life(job.initial_state, static_cast<size_t>(memory_mb) << 20, job.rule);
+  GenerationTracer tracer(job.trace_every, job.iterations);
+  auto start_time = std::chrono::high_resolution_clock::now();
+  tracer.start();
+  // run main computation. this costs roughly log2(iterations) steps, not iterations.
+  // (so the whole run is a single trace interval: stepping in smaller increments to trace it
+  // would change what is being measured)
+  life.advance(job.iterations);
+  tracer.record(job.iterations);
+  auto end_time = std::chrono::high_resolution_clock::now();
+
+  auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
+
+  JobResult result(duration.count(), ca::state_digest(life.to_world()));
+  result.trace = tracer.finish();
+  return result;
+}
+
+std::string CPUHashLife::get_description() {
+  return "Fixed-size world running on CPU with HashLife";
+}
+
+std::string CPUHashLife::get_name() {
+  return "cpu_hashlife";
+}
+
+CPUActiveTiles::CPUActiveTiles(int tile_size) : tile_size(tile_size) {}
+
+JobResult CPUActiveTiles::run(const Job &job) {
+  // pack initial state into bits
+  ca::ActiveTileWorld world(job.initial_state, tile_size, job.rule);
+  std::vector<double> active_tile_fraction;
+  active_tile_fraction.reserve(job.iterations);
+  GenerationTracer tracer(job.trace_every, job.iterations);
+  auto start_time = std::chrono::high_resolution_clock::now();
+  tracer.start();
+  // run main computation
+  for (int i = 0; i < job.iterations; ++i) {
+    active_tile_fraction.push_back(world.step());
+    tracer.record(i + 1);
+  }
+  auto end_time = std::chrono::high_resolution_clock::now();
+
+  auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
+
+  JobResult result(duration.count(), ca::state_digest(world.state()));
+  result.active_tile_fraction = std::move(active_tile_fraction);
+  result.trace = tracer.finish();
+  return result;
+}
+
+std::string CPUActiveTiles::get_description() {
+  return "Fixed-size bit-packed world running on CPU, skipping inactive " +
+         std::to_string(tile_size) + " cell tiles";
+}
+
+std::string CPUActiveTiles::get_name() {
+  return "cpu_active_tiles";
+}
+
+JobResult CPUSparse::run(const Job &job) {
+  // import the initial state with its top left corner at the origin of the plane
+  ca::SparseWorld world(job.initial_state, job.rule);
+  std::vector<long> chunk_count;
+  chunk_count.reserve(job.iterations);
+  GenerationTracer tracer(job.trace_every, job.iterations);
+  auto start_time = std::chrono::high_resolution_clock::now();
+  tracer.start();
+  // run main computation
+  for (int i = 0; i < job.iterations; ++i) {
+    world.step();
+    chunk_count.push_back(static_cast<long>(world.chunk_count()));
+    tracer.record(i + 1);
+  }
+  auto end_time = std::chrono::high_resolution_clock::now();
+
+  auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
+
+  JobResult result(duration.count(),
+                   ca::state_digest(world.to_world(0, 0, job.initial_state.width,
+                                                   job.initial_state.height)));
+  result.chunk_count = std::move(chunk_count);
+  result.trace = tracer.finish();
+  return result;
+}
+
+std::string CPUSparse::get_description() {
+  return "Unbounded world running on CPU, stored as sparse " +
+         std::to_string(ca::SPARSE_CHUNK_SIZE) + " cell chunks";
+}
+
+std::string CPUSparse::get_name() {
+  return "cpu_sparse";
+}
+
+CPULiveCells::CPULiveCells(double dense_density) : dense_density(dense_density) {}
+
+JobResult CPULiveCells::run(const Job &job) {
+  // list the living cells (or pack them, if there are too many)
+  ca::LiveCellWorld world(job.initial_state, job.rule, dense_density);
+  GenerationTracer tracer(job.trace_every, job.iterations);
+  auto start_time = std::chrono::high_resolution_clock::now();
+  tracer.start();
+  // run main computation
+  for (int i = 0; i < job.iterations; ++i) {
+    world.step();
+    tracer.record(i + 1);
+  }
+  auto end_time = std::chrono::high_resolution_clock::now();
+
+  auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
+
+  JobResult result(duration.count(), ca::state_digest(world.to_world()));
+  result.trace = tracer.finish();
+  // how the generations were split between the list and the grid
+  result.kernel_variant = "live_list " + std::to_string(world.sparse_generations()) + ", grid " +
+                          std::to_string(world.dense_generations()) + ", " +
+                          std::to_string(world.switches()) + " switches";
+  return result;
+}
+
+std::string CPULiveCells::get_description() {
+  return "Fixed-size world running on CPU as a list of living cells, switching to a bit-packed "
+         "grid above " + std::to_string(dense_density * 100) + "% density";
+}
+
+std::string CPULiveCells::get_name() {
+  return "cpu_live_cells";
+}
+
+CPUDecomposed::CPUDecomposed(int domains_x, int domains_y)
+    : domains_x(domains_x), domains_y(domains_y) {}
+
+JobResult CPUDecomposed::run(const Job &job) {
+  // the processes time themselves, from a start barrier to their last generation
+  ca::DecomposedRun run =
+      ca::run_decomposed(job.initial_state, job.iterations, job.rule, domains_x, domains_y);
+
+  JobResult result(run.seconds, ca::state_digest(run.final_state));
+  result.compute_seconds = run.compute_seconds;
+  result.comm_seconds = run.comm_seconds;
+  result.child_peak_rss = run.child_peak_rss;
+  return result;
+}
+
+std::string CPUDecomposed::get_description() {
+  return "Fixed-size world split into " + std::to_string(domains_x) + "x" +
+         std::to_string(domains_y) + " subdomains, one process each, exchanging halos through " +
+         "shared memory";
+}
+
+std::string CPUDecomposed::get_name() {
+  return "cpu_decomposed";
+}
+
 JobResult GPUNaive::run(const Job &job) {
-  // allocate memory (on the host) for our two cell arrays
+  // copy the initial state, and allocate the second buffer (from the pool) on the host
   auto width = job.initial_state.width;
   auto height = job.initial_state.height;
-  auto world_size = width * height;
-  ca::cell_t *read_cells = (ca::cell_t *)malloc(world_size * sizeof(ca::cell_t));
-  ca::cell_t *write_cells = (ca::cell_t *)malloc(world_size * sizeof(ca::cell_t));
-
-  // copy initial state to the read buffer
-  std::copy(job.initial_state.state.begin(), job.initial_state.state.end(), read_cells);
+  ca::World read = job.initial_state;
+  ca::World write(width, height);
+  ca::cell_t *read_cells = read.state.data();
+  ca::cell_t *write_cells = write.state.data();
 
   // start the timer
+  GenerationTracer tracer(job.trace_every, job.iterations);
   auto start_time = std::chrono::high_resolution_clock::now();
+  tracer.start();
 
   // variable for tracking which buffer has the final result
   ca::cell_t *result_cells = read_cells;
 
+  // the rule as plain integers, so it can be copied to the device
+  const int birth = job.rule.birth;
+  const int survival = job.rule.survival;
+
 #pragma acc data copy(read_cells[0 : width * height]) create(write_cells[0 : width * height])
   {
     for (int iter = 0; iter < job.iterations; iter++) {
@@ -75,38 +458,188 @@ JobResult GPUNaive::run(const Job &job) {
           alive_neighbors += read_cells[((y + 1) % height) * width + x];
           alive_neighbors += read_cells[((y + 1) % height) * width + ((x + 1) % width)];
 
-          // apply the rules of conway's game of life
-          write_cells[idx] = (read_cells[idx]) ? (alive_neighbors == 2 || alive_neighbors == 3)
-                                               : (alive_neighbors == 3);
+          // apply the rule: look up the neighbor count in the birth or survival mask
+          write_cells[idx] = ((read_cells[idx] ? survival : birth) >> alive_neighbors) & 1;
         }
       }
       std::swap(read_cells, write_cells);
       result_cells = read_cells;
+      // the parallel loop is synchronous, so the generation is done on the device
+      tracer.record(iter + 1);
+    }
+  }
+
+  auto end_time = std::chrono::high_resolution_clock::now();
+  auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
+
+  // build result instance from whichever buffer holds the final state
+  const ca::World &final_state = result_cells == read.state.data() ? read : write;
+  JobResult result(duration.count(), ca::state_digest(final_state));
+  result.trace = tracer.finish();
+
+  return result;
+}
+
+std::string GPUNaive::get_description() {
+  return "Fixed-size world running on GPU";
+}
+
+std::string GPUNaive::get_name() {
+  return "gpu_naive";
+}
+
+JobResult CPUBatched::run(const Job &job) {
+  // a batch of one world
+  return std::move(run_batch({job}).front());
+}
+
+std::vector<JobResult> CPUBatched::run_batch(const std::vector<Job> &jobs) {
+  std::vector<JobResult> results(jobs.size());
+  // jobs that can share a batch: same size, rule and generation count
+  std::vector<bool> done(jobs.size(), false);
+  for (size_t first = 0; first < jobs.size(); ++first) {
+    if (done[first]) continue;
+    const Job &reference = jobs[first];
+    std::vector<size_t> batch;
+    for (size_t j = first; j < jobs.size() && batch.size() < ca::WORLDS_PER_SLICE; ++j) {
+      const Job &job = jobs[j];
+      if (!done[j] && job.initial_state.width == reference.initial_state.width &&
+          job.initial_state.height == reference.initial_state.height &&
+          job.iterations == reference.iterations && job.rule == reference.rule) {
+        batch.push_back(j);
+        done[j] = true;
+      }
+    }
+
+    // interleave the worlds, one bit each
+    ca::SlicedWorld read(reference.initial_state.width, reference.initial_state.height);
+    ca::SlicedWorld write(read.width, read.height);
+    for (size_t k = 0; k < batch.size(); ++k) {
+      read.pack(jobs[batch[k]].initial_state, static_cast<int>(k));
+    }
+    auto start_time = std::chrono::high_resolution_clock::now();
+    // run main computation, every world at once
+    for (int i = 0; i < reference.iterations; ++i) {
+      ca::update_sliced_state(read, write, reference.rule);
+      std::swap(read.cells, write.cells);
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+
+    auto duration =
+        std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
+    for (size_t k = 0; k < batch.size(); ++k) {
+      // each world gets an equal share of the time of its batch
+      JobResult result(duration.count() / batch.size(),
+                       ca::state_digest(read.unpack(static_cast<int>(k))));
+      result.kernel_variant = std::to_string(batch.size()) + " worlds per word";
+      results[batch[k]] = std::move(result);
     }
   }
+  return results;
+}
 
+std::string CPUBatched::get_description() {
+  return "Batches of up to " + std::to_string(ca::WORLDS_PER_SLICE) +
+         " fixed-size worlds running on CPU, bit-sliced one world per bit";
+}
+
+std::string CPUBatched::get_name() {
+  return "cpu_batched";
+}
+
+JobResult CPUBitPacked::run(const Job &job) {
+  // pack initial state into bits
+  ca::BitWorld read(job.initial_state);
+  ca::BitWorld write(read.width, read.height);
+  GenerationTracer tracer(job.trace_every, job.iterations);
+  std::unique_ptr<ca::SnapshotRecorder> recorder;
+  if (job.record_every > 0) {
+    recorder = std::make_unique<ca::SnapshotRecorder>(job.record_file, read.width, read.height,
+                                                      job.rule);
+  }
+  std::unique_ptr<ca::HeadlessRenderer> renderer;
+  if (job.render_every > 0) {
+    renderer = std::make_unique<ca::HeadlessRenderer>(job.render_size, job.render_file,
+                                                      read.width, read.height);
+  }
+  auto start_time = std::chrono::high_resolution_clock::now();
+  tracer.start();
+  auto after_step = [&](int generation) {
+    tracer.record(generation);
+    if (recorder && generation % job.record_every == 0) recorder->record(read, generation);
+    if (renderer && generation % job.render_every == 0) renderer->render(read, generation);
+  };
+  ca::CycleInfo cycles;
+  // run main computation
+  if (job.cycle_mode == ca::CycleMode::OFF) {
+    for (int i = 0; i < job.iterations; ++i) {
+      ca::update_bit_state(read, write, job.rule);
+      std::swap(read.words, write.words);
+      after_step(i + 1);
+    }
+  } else {
+    auto step = [&] {
+      ca::StepStats stats = ca::update_bit_state_counted(read, write, job.rule);
+      std::swap(read.words, write.words);
+      return stats;
+    };
+    cycles = ca::run_with_cycle_detection(job.iterations, job.cycle_mode, step, after_step);
+  }
   auto end_time = std::chrono::high_resolution_clock::now();
+
   auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
 
-  // calculate memory usage: two cell arrays of width*height size
-  size_t memory_usage = 2 * width * height * sizeof(ca::cell_t);
+  // the digest of the packed world matches that of the byte-per-cell benchmarks
+  JobResult result(duration.count(), ca::state_digest(read));
+  result.trace = tracer.finish();
+  result.cycles = cycles;
+  if (recorder) {
+    // the snapshots still queued are written after the timed loop
+    result.recording = recorder->finish();
+    result.recording.overhead = result.recording.record_seconds / duration.count();
+  }
+  if (renderer) {
+    result.render = renderer->stats();
+    result.render.overhead =
+        (result.render.render_seconds + result.render.write_seconds) / duration.count();
+  }
+  return result;
+}
 
-  // copy final state into a ca::World instance
-  ca::World final_state;
-  final_state.width = width;
-  final_state.height = height;
-  final_state.state = std::vector<ca::cell_t>(result_cells, result_cells + width * height);
+std::string CPUBitPacked::get_description() {
+  return "Fixed-size bit-packed world running on CPU";
+}
 
-  // build result instance
-  JobResult result(duration.count(), memory_usage, final_state);
+std::string CPUBitPacked::get_name() {
+  return "cpu_bit_packed";
+}
 
-  // free buffers
-  free(read_cells);
-  free(write_cells);
+CPUAuto::CPUAuto(ca::TuningCache cache, std::vector<std::unique_ptr<Benchmark>> engines)
+    : cache(std::move(cache)), engines(std::move(engines)) {}
 
+JobResult CPUAuto::run(const Job &job) {
+  const int width_height = std::max(job.initial_state.width, job.initial_state.height);
+  const ca::TunedConfig *config = cache.find(width_height, job.iterations);
+  Benchmark &engine = *engines[config - cache.configs().data()];
+  JobResult result = engine.run(job);
+  // the engine's own variant, if it has several, after the configuration
+  std::string variant = config->describe();
+  if (config->width_height == 0) variant += " (untuned)";
+  if (!result.kernel_variant.empty()) variant += " (" + result.kernel_variant + ")";
+  result.kernel_variant = variant;
   return result;
 }
 
-std::string GPUNaive::get_description() {
-  return "Fixed-size world running on GPU";
+std::string CPUAuto::get_description() {
+  return "Fixed-size world running on CPU with the engine tuned for its size (" +
+         std::to_string(cache.configs().size()) + " tuned configurations)";
+}
+
+std::string CPUAuto::get_name() {
+  return "auto";
+}
+
+bool CPUAuto::is_reentrant() {
+  return std::all_of(engines.begin(), engines.end(),
+                     [](const auto &engine) { return engine->is_reentrant(); });
 }
@@ -3,11 +3,24 @@
 #pragma once
 
 #include <chrono>
+#include <iomanip>
+#include <memory>
+#include <sstream>
 #include <vector>
 #include <string>
 
+#include "cycle_detection.h"
+#include "framebuffer.h"
+#include "rule.h"
 #include "types.h"
 #include "json_helper.h"
+#include "stats.h"
+#include "snapshot_recorder.h"
+#include "state_hash.h"
+#include "perf_counters.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include "tuning_cache.h"
 
 // A Job describes the work that is to be done by a Benchmark.
 // It is passed into the benchmark's run method.
@@ -15,20 +28,134 @@ struct Job {
   ca::World initial_state;
   int iterations;
   std::string description;
+  ca::Rule rule{ca::CONWAY};
+  // take a timestamp every this many generations (see GenerationTracer). 0 disables tracing.
+  int trace_every{0};
+  // record a snapshot into record_file every this many generations (see ca::SnapshotRecorder).
+  // 0 disables recording. only some engines support it.
+  int record_every{0};
+  std::string record_file{};
+  // draw a render_size x render_size frame of the whole world every this many generations (see
+  // ca::HeadlessRenderer), and write it to render_file unless it is empty. 0 disables rendering.
+  // only some engines support it.
+  int render_every{0};
+  int render_size{512};
+  std::string render_file{};
+  // reduce every generation and look for still lifes and oscillators (see ca::CycleMode).
+  // only some engines support it; the others always run every generation.
+  ca::CycleMode cycle_mode{ca::CycleMode::OFF};
 };
 
 // After a job is ran through a benchmark, a JobResult is returned
-// which contains some useful metrics and the final state.
+// which contains some useful metrics and a digest of the final state.
+// Move-only: results (and their traces) are moved from the engine into the harness and then
+// into the sweep's output, never copied.
 struct JobResult {
+  // median over the timed repetitions of the job
   double duration{0};
-  unsigned long memory_required{0};
-  ca::World final_state;
+  // peak resident set size of the process while the job ran, and its growth over the resident
+  // size at the start of the job (see memory_usage.h). filled in by the harness.
+  unsigned long peak_rss{0};
+  unsigned long peak_rss_growth{0};
+  // false if the peak could not be reset before the job, so that it covers the process lifetime
+  bool peak_rss_per_job{false};
+  // most bytes of pooled buffers (see buffer_pool.h) handed out at once while the job ran. the
+  // resident size also counts the buffers the pool keeps idle, this only the ones in use.
+  unsigned long pool_peak_bytes{0};
+  // sum of the peak resident set sizes of the worker processes (only the multi-process engine)
+  unsigned long child_peak_rss{0};
+  // hash and population of the final state, compared across benchmarks for validation
+  ca::StateDigest digest;
+  // fraction of tiles recomputed in each generation (only filled in by tiled engines)
+  std::vector<double> active_tile_fraction{};
+  // number of allocated chunks in each generation (only filled in by the unbounded engine)
+  std::vector<long> chunk_count{};
+  // duration of every timed repetition (warmup runs excluded)
+  std::vector<double> durations{};
+  // hardware counters per timed repetition (only filled in when requested)
+  ca::PerfCounts perf{};
+  // per-generation timestamps of the last timed repetition (only filled in when requested)
+  GenerationTrace trace{};
+  // time spent computing and exchanging halos (only filled in by the multi-process engine)
+  double compute_seconds{-1};
+  double comm_seconds{-1};
+  // cost of recording snapshots (only filled in when recording)
+  ca::RecordingStats recording{};
+  // cost of drawing (and writing) frames (only filled in when rendering)
+  ca::RenderStats render{};
+  // detected period and the generation the run stopped at (only filled in with a cycle mode)
+  ca::CycleInfo cycles{};
+  // which specialization of the kernel ran (only filled in by engines that have several)
+  std::string kernel_variant{};
+
+  JobResult() = default;
+  JobResult(double duration, ca::StateDigest digest) : duration(duration), digest(digest) {}
+  JobResult(JobResult &&) = default;
+  JobResult &operator=(JobResult &&) = default;
+  JobResult(const JobResult &) = delete;
+  JobResult &operator=(const JobResult &) = delete;
 
   std::string to_json() const {
     std::stringstream ss;
     ss << "{";
     ss << "\"duration\": " << std::fixed << std::setprecision(6) << duration << ",";
-    ss << "\"memory_required\": " << memory_required;
+    ss << "\"peak_rss\": " << peak_rss << ",";
+    ss << "\"peak_rss_growth\": " << peak_rss_growth << ",";
+    ss << "\"peak_rss_per_job\": " << (peak_rss_per_job ? "true" : "false") << ",";
+    ss << "\"pool_peak_bytes\": " << pool_peak_bytes << ",";
+    if (child_peak_rss > 0) ss << "\"child_peak_rss\": " << child_peak_rss << ",";
+    ss << "\"state_hash\": \"" << digest.hash_string() << "\",";
+    ss << "\"population\": " << digest.population;
+    if (!kernel_variant.empty()) {
+      ss << ",\"kernel_variant\": \"" << kernel_variant << "\"";
+    }
+    if (!active_tile_fraction.empty()) {
+      ss << ",\"active_tile_fraction\": [";
+      for (size_t i = 0; i < active_tile_fraction.size(); ++i) {
+        if (i > 0) ss << ",";
+        ss << std::setprecision(4) << active_tile_fraction[i];
+      }
+      ss << "]";
+    }
+    if (durations.size() > 1) {
+      ss << ",\"durations\": [";
+      for (size_t i = 0; i < durations.size(); ++i) {
+        if (i > 0) ss << ",";
+        ss << std::defaultfloat << std::setprecision(6) << durations[i];
+      }
+      ss << "]";
+    }
+    if (comm_seconds >= 0) {
+      ss << std::defaultfloat << std::setprecision(6);
+      ss << ",\"compute_seconds\": " << compute_seconds;
+      ss << ",\"comm_seconds\": " << comm_seconds;
+    }
+    if (recording.snapshots > 0) {
+      ss << ",\"recording\": " << recording.to_json();
+    }
+    if (render.frames > 0) {
+      ss << ",\"render\": " << render.to_json();
+    }
+    if (cycles.stop_generation >= 0) {
+      ss << ",\"period\": " << cycles.period;
+      ss << ",\"cycle_first_seen\": " << cycles.first_seen;
+      ss << ",\"stop_generation\": " << cycles.stop_generation;
+      ss << ",\"stopped_early\": " << (cycles.stopped_early ? "true" : "false");
+    }
+    if (!trace.empty()) {
+      ss << ",\"generation_latency\": " << trace.summary_json();
+    }
+    if (perf.enabled) {
+      ss << ",\"perf\": " << perf.to_json();
+    }
+    if (!chunk_count.empty()) {
+      ss << ",\"chunk_count\": [";
+      for (size_t i = 0; i < chunk_count.size(); ++i) {
+        if (i > 0) ss << ",";
+        ss << chunk_count[i];
+      }
+      ss << "]";
+    }
     ss << "}";
     return ss.str();
   }
@@ -38,11 +165,25 @@ struct JobResult {
 struct BenchmarkResult {
   std::vector<JobResult> results{};
   std::string description;
+  // number of worker threads used. 0 for benchmarks that are not multithreaded.
+  int num_threads{0};
+  // speedup over the single threaded run of the same benchmark, divided by num_threads
+  double scaling_efficiency{0};
+  // statistics over every timed repetition of every job
+  DurationStats stats{};
+  // jobs and cells per second over the whole batch of jobs
+  Throughput throughput{};
 
   std::string to_json() const {
     std::stringstream ss;
     ss << "{";
     ss << "\"description\": \"" << escape_json_string(description) << "\",";
+    ss << "\"stats\": " << stats.to_json() << ",";
+    ss << "\"throughput\": " << throughput.to_json() << ",";
+    if (num_threads > 0) {
+      ss << "\"num_threads\": " << num_threads << ",";
+      ss << "\"scaling_efficiency\": " << std::fixed << std::setprecision(6) << scaling_efficiency << ",";
+    }
     ss << "\"results\": [";
     for (size_t i = 0; i < results.size(); ++i) {
         if (i > 0) ss << ",";
@@ -53,7 +194,7 @@ struct BenchmarkResult {
   }
 };
 
-// Interface describing a benchmark. Implemented by CPUNaive and GPUNaive
+// Interface describing a benchmark. Implemented by CPUNaive, GPUNaive, CPUBitPacked, CPUHalo, etc.
 class Benchmark {
 public:
   virtual ~Benchmark() {};
@@ -63,6 +204,25 @@ public:
   virtual JobResult run(const Job &job) = 0;
   // Returns a description of this benchmark.
   virtual std::string get_description() = 0;
+  // Returns the short name used to select this benchmark (e.g. on the command line).
+  virtual std::string get_name() = 0;
+  // Returns the number of worker threads this benchmark uses, or 0 if it is not multithreaded.
+  virtual int get_num_threads() { return 0; }
+  // Can run() be called from several threads at once? Benchmarks that share state between runs
+  // (a thread pool, a device) return false, and always run their jobs one at a time.
+  virtual bool is_reentrant() { return true; }
+  // Does this benchmark run a whole batch of jobs together? If so, the harness times run_batch
+  // over every job rather than run() on each.
+  virtual bool is_batched() { return false; }
+  // Execute every job, returning one result per job in the same order. Each result's duration is
+  // its share of the batch's time. The default runs the jobs one by one.
+  virtual std::vector<JobResult> run_batch(const std::vector<Job> &jobs) {
+    std::vector<JobResult> results;
+    for (const auto &job : jobs) {
+      results.push_back(run(job));
+    }
+    return results;
+  }
 };
 
 // CPU implementation of Conway's Game of Life on a fixed-size grid
@@ -70,10 +230,161 @@ class CPUNaive : public Benchmark {
 public:
   JobResult run(const Job &job) override;
   std::string get_description() override;
+  std::string get_name() override;
+};
+// CPU implementation of Conway's Game of Life on a fixed-size grid, with the kernel specialized
+// for the world's size (see ca::with_size_policy)
+class CPUSized : public Benchmark {
+public:
+  JobResult run(const Job &job) override;
+  std::string get_description() override;
+  std::string get_name() override;
+};
+// CPU implementation of Conway's Game of Life on batches of same-sized worlds, bit-sliced so that
+// each word holds one cell of 64 worlds (see ca::SlicedWorld). Jobs that share a size, rule and
+// generation count are advanced together.
+class CPUBatched : public Benchmark {
+public:
+  JobResult run(const Job &job) override;
+  std::vector<JobResult> run_batch(const std::vector<Job> &jobs) override;
+  std::string get_description() override;
+  std::string get_name() override;
+  bool is_batched() override { return true; }
+};
+// CPU implementation of Conway's Game of Life on a fixed-size grid, using ghost cells
+// for the toroidal wrap and an explicit SIMD kernel (AVX-512, AVX2 or SSE2) over whole rows
+class CPUHalo : public Benchmark {
+public:
+  JobResult run(const Job &job) override;
+  std::string get_description() override;
+  std::string get_name() override;
+};
+// Multithreaded CPU implementation of Conway's Game of Life on a fixed-size bit-packed grid.
+// The world is split into horizontal bands, one per thread of a persistent thread pool,
+// and the threads synchronize with a barrier after every generation.
+class CPUParallel : public Benchmark {
+public:
+  CPUParallel(int num_threads, bool pin_threads);
+
+  JobResult run(const Job &job) override;
+  std::string get_description() override;
+  std::string get_name() override;
+  int get_num_threads() override;
+  bool is_reentrant() override { return false; }
+
+private:
+  ca::ThreadPool pool;
+  bool pin_threads;
 };
+// CPU implementation of Conway's Game of Life on a fixed-size bit-packed grid using temporal
+// blocking: each cache-sized tile is advanced by several generations at once.
+class CPUTemporal : public Benchmark {
+public:
+  // throws std::invalid_argument if tile_generations is not positive
+  CPUTemporal(int tile_size, int tile_generations);
+
+  JobResult run(const Job &job) override;
+  std::string get_description() override;
+  std::string get_name() override;
+
+private:
+  int tile_size;
+  int tile_generations;
+};
+// HashLife implementation of Conway's Game of Life on a fixed-size grid. The torus is embedded
+// in the plane by periodic tiling, so results match the other benchmarks exactly.
+class CPUHashLife : public Benchmark {
+public:
+  explicit CPUHashLife(int memory_mb);
+
+  JobResult run(const Job &job) override;
+  std::string get_description() override;
+  std::string get_name() override;
+
+private:
+  int memory_mb;
+};
+// CPU implementation of Conway's Game of Life on a fixed-size bit-packed grid that only
+// recomputes tiles whose neighborhood changed in the previous generation
+class CPUActiveTiles : public Benchmark {
+public:
+  explicit CPUActiveTiles(int tile_size);
+
+  JobResult run(const Job &job) override;
+  std::string get_description() override;
+  std::string get_name() override;
+
+private:
+  int tile_size;
+};
+// CPU implementation of Conway's Game of Life on an unbounded plane, stored as sparse chunks.
+// The result is the window of the plane covered by the job's world, so it only matches the
+// toroidal benchmarks if the pattern never reaches the edges of that world.
+class CPUSparse : public Benchmark {
+public:
+  JobResult run(const Job &job) override;
+  std::string get_description() override;
+  std::string get_name() override;
+};
+// CPU implementation of Conway's Game of Life on a fixed-size grid for sparse worlds: a sorted
+// list of the living cells while the density is below a threshold, the bit-packed grid above it
+// (see ca::LiveCellWorld)
+class CPULiveCells : public Benchmark {
+public:
+  explicit CPULiveCells(double dense_density);
+
+  JobResult run(const Job &job) override;
+  std::string get_description() override;
+  std::string get_name() override;
+
+private:
+  double dense_density;
+};
+// Fixed-size byte-per-cell world split into a grid of subdomains, one process each,
+// exchanging halos through shared memory (see domain_decomposition.h)
+class CPUDecomposed : public Benchmark {
+public:
+  CPUDecomposed(int domains_x, int domains_y);
+  JobResult run(const Job &job) override;
+  std::string get_description() override;
+  std::string get_name() override;
+  // the processes are forked from the calling thread
+  bool is_reentrant() override { return false; }
+
+private:
+  int domains_x;
+  int domains_y;
+};
+
 // GPU implementation of Conway's Game of Life on a fixed-size grid (using openacc)
 class GPUNaive : public Benchmark {
 public:
   JobResult run(const Job &job) override;
   std::string get_description() override;
+  std::string get_name() override;
+  // every run shares the one device
+  bool is_reentrant() override { return false; }
+};
+// CPU implementation of Conway's Game of Life on a fixed-size grid, packed 64 cells per word
+class CPUBitPacked : public Benchmark {
+public:
+  JobResult run(const Job &job) override;
+  std::string get_description() override;
+  std::string get_name() override;
+};
+// Runs each job with the configuration the autotuner found fastest for the closest world size and
+// generation count (see autotune.h). The cache is read once, when the benchmark is created.
+class CPUAuto : public Benchmark {
+public:
+  // engines[i] runs cache.configs()[i]
+  CPUAuto(ca::TuningCache cache, std::vector<std::unique_ptr<Benchmark>> engines);
+
+  JobResult run(const Job &job) override;
+  std::string get_description() override;
+  std::string get_name() override;
+  bool is_reentrant() override;
+
+private:
+  ca::TuningCache cache;
+  std::vector<std::unique_ptr<Benchmark>> engines;
 };
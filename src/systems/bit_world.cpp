@@ -0,0 +1,231 @@
+// Defines a bit-packed representation of the cellular automata state, along with
+// a CPU update kernel that computes 64 cells at a time using bitwise full adders.
+#include "bit_world.h"
+
+#include <bit>
+
+namespace ca {
+
+BitWorld::BitWorld(int width, int height) {
+  this->width = width;
+  this->height = height;
+  words_per_row = (width + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+  words.assign(static_cast<size_t>(words_per_row) * height, 0);
+}
+
+BitWorld::BitWorld(const World &world) : BitWorld(world.width, world.height) {
+  for (int y = 0; y < height; y++) {
+    const cell_t *src = &world.state[static_cast<size_t>(y) * width];
+    word_t *dst = &words[static_cast<size_t>(y) * words_per_row];
+    for (int x = 0; x < width; x++) {
+      dst[x / CELLS_PER_WORD] |= static_cast<word_t>(src[x] != 0) << (x % CELLS_PER_WORD);
+    }
+  }
+}
+
+World BitWorld::to_world() const {
+  World world;
+  world.width = width;
+  world.height = height;
+  world.state.resize(static_cast<size_t>(width) * height);
+  for (int y = 0; y < height; y++) {
+    const word_t *src = &words[static_cast<size_t>(y) * words_per_row];
+    cell_t *dst = &world.state[static_cast<size_t>(y) * width];
+    for (int x = 0; x < width; x++) {
+      dst[x] = (src[x / CELLS_PER_WORD] >> (x % CELLS_PER_WORD)) & 1;
+    }
+  }
+  return world;
+}
+
+word_t BitWorld::last_word_mask() const {
+  int valid = width - (words_per_row - 1) * CELLS_PER_WORD;
+  return valid == CELLS_PER_WORD ? ~word_t{0} : (word_t{1} << valid) - 1;
+}
+
+word_t BitWorld::load_word(long x, long y) const {
+  x = ((x % width) + width) % width;
+  y = ((y % height) + height) % height;
+  const word_t *row = &words[static_cast<size_t>(y) * words_per_row];
+  const int word = static_cast<int>(x / CELLS_PER_WORD);
+  const int bit = static_cast<int>(x % CELLS_PER_WORD);
+  if (x + CELLS_PER_WORD <= width) {
+    // fast path: the 64 cells straddle at most two words and do not wrap
+    word_t low = row[word] >> bit;
+    return bit == 0 ? low : low | (row[word + 1] << (CELLS_PER_WORD - bit));
+  }
+  // slow path near the east edge: gather cell by cell, wrapping to column 0
+  word_t result = 0;
+  for (int i = 0; i < CELLS_PER_WORD; i++) {
+    long cx = (x + i) % width;
+    result |= ((row[cx / CELLS_PER_WORD] >> (cx % CELLS_PER_WORD)) & 1) << i;
+  }
+  return result;
+}
+
+namespace {
+/**
+ * @brief update words [w_begin, w_end) of one row of a bit-packed world
+ *
+ * @tparam Count also reduce the updated words into the returned StepStats (otherwise it is empty)
+ * @param up the row above (already wrapped vertically)
+ * @param mid the row being updated
+ * @param down the row below (already wrapped vertically)
+ * @param out destination row
+ * @param row_index index of the first word of the row (y * words_per_row), for the hash
+ * @param kernel word kernel applying the rule (see RuleKernel)
+ */
+template <bool Count, typename Kernel>
+StepStats update_row(const word_t *up, const word_t *mid, const word_t *down, word_t *out,
+                     std::uint64_t row_index, int words_per_row, int width, word_t last_mask,
+                     int w_begin, int w_end, Kernel kernel) {
+  const int last = words_per_row - 1;
+  const int last_bit = (width - 1) % CELLS_PER_WORD;
+
+  // the cell to the west of x = 0 is x = width - 1, and the cell to the east
+  // of x = width - 1 is x = 0. these are the only wrapped neighbors in a row.
+  auto west = [&](const word_t *row, int i) -> word_t {
+    word_t carry_in = i > 0 ? row[i - 1] >> (CELLS_PER_WORD - 1) : (row[last] >> last_bit) & 1;
+    return (row[i] << 1) | carry_in;
+  };
+  auto east = [&](const word_t *row, int i) -> word_t {
+    word_t carry_in = i < last ? row[i + 1] << (CELLS_PER_WORD - 1) : (row[0] & 1) << last_bit;
+    return (row[i] >> 1) | carry_in;
+  };
+  auto compute = [&](int i) -> word_t {
+    word_t next = kernel(west(up, i), up[i], east(up, i), west(mid, i), mid[i], east(mid, i),
+                         west(down, i), down[i], east(down, i));
+    // keep the padding bits of the last word clear
+    return i == last ? next & last_mask : next;
+  };
+
+  const int begin = w_begin;
+  const int end = w_end;
+  // first word (handles the west wrap)
+  if (w_begin == 0) {
+    out[0] = compute(0);
+    w_begin = 1;
+  }
+  // last word (handles the east wrap)
+  if (w_end == words_per_row && w_begin <= last) {
+    out[last] = compute(last);
+    w_end = last;
+  }
+
+  // interior words have no wrapping at all, so use the shifts directly
+  for (int i = w_begin; i < w_end; i++) {
+    out[i] = kernel((up[i] << 1) | (up[i - 1] >> 63), up[i], (up[i] >> 1) | (up[i + 1] << 63),
+                    (mid[i] << 1) | (mid[i - 1] >> 63), mid[i], (mid[i] >> 1) | (mid[i + 1] << 63),
+                    (down[i] << 1) | (down[i - 1] >> 63), down[i],
+                    (down[i] >> 1) | (down[i + 1] << 63));
+  }
+
+  StepStats stats;
+  if constexpr (Count) {
+    // reduce the row while it is still in L1. doing it inside the loop above would keep the
+    // compiler from vectorizing the kernel, since there is no vector popcount to use.
+    std::uint64_t population = 0, changed = 0, hash = 0;
+    for (int i = begin; i < end; i++) {
+      population += std::popcount(out[i]);
+      changed += std::popcount(out[i] ^ mid[i]);
+      hash += step_word_hash(out[i], row_index + i);
+    }
+    stats = {population, changed, hash};
+  }
+  return stats;
+}
+
+template <bool Count>
+StepStats update_rect(const BitWorld &read, BitWorld &write, Rule rule, int y_begin, int y_end,
+                      int w_begin, int w_end) {
+  const int wpr = read.words_per_row;
+  const word_t last_mask = read.last_word_mask();
+  StepStats stats;
+  // pick the rule's kernel once, outside the loops
+  with_rule_kernel(rule, [&](auto kernel) {
+    for (int y = y_begin; y < y_end; y++) {
+      // wrap vertically once per row instead of once per neighbor
+      int y_up = y == 0 ? read.height - 1 : y - 1;
+      int y_down = y == read.height - 1 ? 0 : y + 1;
+      const std::uint64_t row_index = static_cast<std::uint64_t>(y) * wpr;
+      stats += update_row<Count>(&read.words[static_cast<size_t>(y_up) * wpr],
+                                 &read.words[row_index],
+                                 &read.words[static_cast<size_t>(y_down) * wpr],
+                                 &write.words[row_index], row_index, wpr, read.width, last_mask,
+                                 w_begin, w_end, kernel);
+    }
+  });
+  return stats;
+}
+} // namespace
+
+/**
+ * @brief perform one iteration of the given rule on a bit-packed world
+ *
+ * @param read the current state of the world
+ * @param write the next state of the world
+ * @param rule the rule to apply
+ */
+void update_bit_state(const BitWorld &read, BitWorld &write, Rule rule) {
+  update_bit_state(read, write, rule, 0, read.height);
+}
+
+/**
+ * @brief perform one iteration of the given rule on a band of rows of a bit-packed world
+ *
+ * @param read the current state of the world
+ * @param write the next state of the world
+ * @param rule the rule to apply
+ * @param y_begin first row to update
+ * @param y_end one past the last row to update
+ */
+void update_bit_state(const BitWorld &read, BitWorld &write, Rule rule, int y_begin, int y_end) {
+  update_bit_state(read, write, rule, y_begin, y_end, 0, read.words_per_row);
+}
+
+/**
+ * @brief perform one iteration of the given rule on a rectangle of a bit-packed world
+ *
+ * @param read the current state of the world
+ * @param write the next state of the world
+ * @param rule the rule to apply
+ * @param y_begin first row to update
+ * @param y_end one past the last row to update
+ * @param w_begin first word of each row to update
+ * @param w_end one past the last word of each row to update
+ */
+void update_bit_state(const BitWorld &read, BitWorld &write, Rule rule, int y_begin, int y_end,
+                      int w_begin, int w_end) {
+  update_rect<false>(read, write, rule, y_begin, y_end, w_begin, w_end);
+}
+
+/**
+ * @brief perform one iteration of the given rule on a bit-packed world, and reduce the new state
+ * in the same pass
+ *
+ * @param read the current state of the world
+ * @param write the next state of the world
+ * @param rule the rule to apply
+ * @return population, changed cells and hash of the new state
+ */
+StepStats update_bit_state_counted(const BitWorld &read, BitWorld &write, Rule rule) {
+  return update_bit_state_counted(read, write, rule, 0, read.height);
+}
+
+/**
+ * @brief perform one iteration of the given rule on a band of rows of a bit-packed world, and
+ * reduce the updated rows in the same pass
+ *
+ * @param read the current state of the world
+ * @param write the next state of the world
+ * @param rule the rule to apply
+ * @param y_begin first row to update
+ * @param y_end one past the last row to update
+ * @return population, changed cells and hash of the updated rows
+ */
+StepStats update_bit_state_counted(const BitWorld &read, BitWorld &write, Rule rule, int y_begin,
+                                   int y_end) {
+  return update_rect<true>(read, write, rule, y_begin, y_end, 0, read.words_per_row);
+}
+
+} // namespace ca
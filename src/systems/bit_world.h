@@ -0,0 +1,222 @@
+// Defines a bit-packed representation of the cellular automata state, along with
+// a CPU update kernel that computes 64 cells at a time using bitwise full adders.
+// Kernels are specialized per rule at compile time (see RuleKernel and with_rule_kernel).
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "buffer_pool.h"
+#include "rule.h"
+#include "types.h"
+
+namespace ca {
+// 64 cells are packed into one machine word. Bit i of word w in a row holds cell x = 64 * w + i.
+using word_t = std::uint64_t;
+constexpr int CELLS_PER_WORD = 64;
+
+// Bit-packed version of World. Each row is padded up to a whole number of words,
+// and the padding bits in the last word of each row are always kept at zero.
+struct BitWorld {
+  pooled_vector<word_t> words;
+  int width{0};
+  int height{0};
+  int words_per_row{0};
+
+  BitWorld() = default;
+  // allocate an all-dead world of the given dimensions
+  BitWorld(int width, int height);
+  // pack a byte-per-cell world into bits
+  explicit BitWorld(const World &world);
+
+  // unpack back into a byte-per-cell world (used for validation against the other benchmarks)
+  World to_world() const;
+
+  // mask of the valid bits in the last word of each row
+  word_t last_word_mask() const;
+
+  // the 64 cells of row y starting at column x, wrapping around the world in both directions.
+  // bit i of the result is cell (x + i, y). x and y may be out of range.
+  word_t load_word(long x, long y) const;
+
+  unsigned long get_mem_size() const {
+    return words.size() * sizeof(word_t) + 3 * sizeof(int);
+  }
+};
+
+// full adder over three bit-planes: sum receives the ones bit, carry the twos bit
+inline void full_add(word_t a, word_t b, word_t c, word_t &sum, word_t &carry) {
+  word_t t = a ^ b;
+  sum = t ^ c;
+  carry = (a & b) | (t & c);
+}
+
+/**
+ * @brief compute the next state of 64 cells from their 3x3 neighborhood, given as bit-planes
+ *
+ * each argument holds one neighbor direction for all 64 cells at once (e.g. nw holds
+ * the north-west neighbor of every cell in the word).
+ */
+inline word_t life_word(word_t nw, word_t n, word_t ne, word_t w, word_t c, word_t e,
+                        word_t sw, word_t s, word_t se) {
+  // count the top and bottom rows (0..3 each) and the middle row (0..2)
+  word_t top_ones, top_twos, bot_ones, bot_twos;
+  full_add(nw, n, ne, top_ones, top_twos);
+  full_add(sw, s, se, bot_ones, bot_twos);
+  word_t mid_ones = w ^ e;
+  word_t mid_twos = w & e;
+
+  // combine the ones bits, carrying into the twos column
+  word_t ones, ones_carry;
+  full_add(top_ones, bot_ones, mid_ones, ones, ones_carry);
+
+  // combine the four twos bits, carrying into the fours column
+  word_t twos_partial, fours_a;
+  full_add(top_twos, bot_twos, mid_twos, twos_partial, fours_a);
+  word_t twos = twos_partial ^ ones_carry;
+  word_t fours_b = twos_partial & ones_carry;
+  word_t fours = fours_a | fours_b;  // only both set when the count is 8
+
+  // alive next generation if count == 3, or count == 2 and currently alive.
+  // a count of 8 has fours set, so it is rejected as well.
+  return ~fours & twos & (ones | c);
+}
+
+// full neighbor count (0..8) of 64 cells, as four bit-planes
+struct NeighborCount {
+  word_t ones, twos, fours, eights;
+
+  // cells whose count is exactly n
+  word_t equals(int n) const {
+    return (n & 1 ? ones : ~ones) & (n & 2 ? twos : ~twos) & (n & 4 ? fours : ~fours) &
+           (n & 8 ? eights : ~eights);
+  }
+};
+
+// same adder network as life_word, but keeps the full count so any rule can be applied
+inline NeighborCount count_neighbors(word_t nw, word_t n, word_t ne, word_t w, word_t e,
+                                     word_t sw, word_t s, word_t se) {
+  word_t top_ones, top_twos, bot_ones, bot_twos;
+  full_add(nw, n, ne, top_ones, top_twos);
+  full_add(sw, s, se, bot_ones, bot_twos);
+  word_t ones, ones_carry;
+  full_add(top_ones, bot_ones, w ^ e, ones, ones_carry);
+  word_t twos_partial, fours_a;
+  full_add(top_twos, bot_twos, w & e, twos_partial, fours_a);
+  word_t fours_b = twos_partial & ones_carry;
+  return {ones, twos_partial ^ ones_carry, fours_a ^ fours_b, fours_a & fours_b};
+}
+
+// Word kernel specialized at compile time for one rule. Only the counts that the rule actually
+// uses are tested, so each rule gets its own branch-free circuit.
+template <Rule R>
+struct RuleKernel {
+  word_t operator()(word_t nw, word_t n, word_t ne, word_t w, word_t c, word_t e, word_t sw,
+                    word_t s, word_t se) const {
+    if constexpr (R == CONWAY) {
+      // hand-optimized circuit
+      return life_word(nw, n, ne, w, c, e, sw, s, se);
+    } else {
+      const NeighborCount count = count_neighbors(nw, n, ne, w, e, sw, s, se);
+      word_t next = 0;
+      [&]<int... K>(std::integer_sequence<int, K...>) {
+        ((next |= term<K>(count, c)), ...);
+      }(std::make_integer_sequence<int, 9>{});
+      return next;
+    }
+  }
+
+  template <int K>
+  static word_t term(const NeighborCount &count, word_t c) {
+    constexpr bool born = (R.birth >> K) & 1;
+    constexpr bool survives = (R.survival >> K) & 1;
+    if constexpr (born && survives) {
+      return count.equals(K);
+    } else if constexpr (born) {
+      return count.equals(K) & ~c;
+    } else if constexpr (survives) {
+      return count.equals(K) & c;
+    } else {
+      return 0;
+    }
+  }
+};
+
+// Word kernel for rules that have no compiled specialization. Still branch-free per word:
+// the rule is turned into all-ones / all-zeros masks once, when the kernel is created.
+struct DynamicRuleKernel {
+  word_t birth_masks[9];
+  word_t survival_masks[9];
+
+  explicit DynamicRuleKernel(Rule rule) {
+    for (int k = 0; k <= 8; k++) {
+      birth_masks[k] = ((rule.birth >> k) & 1) ? ~word_t{0} : 0;
+      survival_masks[k] = ((rule.survival >> k) & 1) ? ~word_t{0} : 0;
+    }
+  }
+
+  word_t operator()(word_t nw, word_t n, word_t ne, word_t w, word_t c, word_t e, word_t sw,
+                    word_t s, word_t se) const {
+    const NeighborCount count = count_neighbors(nw, n, ne, w, e, sw, s, se);
+    word_t next = 0;
+    for (int k = 0; k <= 8; k++) {
+      next |= count.equals(k) & ((birth_masks[k] & ~c) | (survival_masks[k] & c));
+    }
+    return next;
+  }
+};
+
+/**
+ * @brief call f with the word kernel for the given rule: a compile-time specialized
+ * RuleKernel for the well known rules, or a DynamicRuleKernel for anything else.
+ */
+template <typename F>
+decltype(auto) with_rule_kernel(Rule rule, F &&f) {
+  if (rule == CONWAY) return f(RuleKernel<CONWAY>{});
+  if (rule == HIGHLIFE) return f(RuleKernel<HIGHLIFE>{});
+  if (rule == DAY_AND_NIGHT) return f(RuleKernel<DAY_AND_NIGHT>{});
+  if (rule == SEEDS) return f(RuleKernel<SEEDS>{});
+  return f(DynamicRuleKernel(rule));
+}
+
+// Reductions over one generation, computed in the same pass as the update (see
+// update_bit_state_counted). hash sums step_word_hash over the words of the new state, so bands
+// of rows can be reduced by different threads and combined with +=.
+struct StepStats {
+  std::uint64_t population{0};
+  // cells that differ from the previous generation
+  std::uint64_t changed{0};
+  std::uint64_t hash{0};
+
+  StepStats &operator+=(const StepStats &other) {
+    population += other.population;
+    changed += other.changed;
+    hash += other.hash;
+    return *this;
+  }
+};
+
+// contribution of one packed word (bits as in BitWorld) at the given index (row * words_per_row
+// + word) to StepStats::hash
+inline std::uint64_t step_word_hash(word_t word, std::uint64_t index) {
+  // a single multiply and xorshift, both invertible, so any change to one word changes its term.
+  // cheap enough to vectorize, unlike the full splitmix64 finalizer the digest uses.
+  std::uint64_t key = (word ^ (index * 0x9e3779b97f4a7c15ULL)) * 0xbf58476d1ce4e5b9ULL;
+  return key ^ (key >> 29);
+}
+
+// perform one iteration of the given rule on a bit-packed world
+void update_bit_state(const BitWorld &read, BitWorld &write, Rule rule);
+// same as above, but only updates rows [y_begin, y_end). used to split the work between threads.
+void update_bit_state(const BitWorld &read, BitWorld &write, Rule rule, int y_begin, int y_end);
+// same as above, but only updates words [w_begin, w_end) of each row. used for tiling.
+void update_bit_state(const BitWorld &read, BitWorld &write, Rule rule, int y_begin, int y_end,
+                      int w_begin, int w_end);
+// same as update_bit_state, but also returns the population, changed cells and hash of the
+// updated rows
+StepStats update_bit_state_counted(const BitWorld &read, BitWorld &write, Rule rule);
+StepStats update_bit_state_counted(const BitWorld &read, BitWorld &write, Rule rule, int y_begin,
+                                   int y_end);
+
+} // namespace ca
@@ -0,0 +1,135 @@
+// Defines a process-wide pool of aligned buffers that are recycled between jobs and sweep points,
+// so that once every buffer size has been seen, running a job allocates nothing from the heap.
+// Buffers large enough to span huge pages are aligned to them and advised to use them.
+#include "buffer_pool.h"
+
+#include <malloc.h>
+#include <sys/mman.h>
+
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+namespace ca {
+
+namespace {
+// the size a pooled buffer is actually allocated with, so that acquire and release agree on it
+std::size_t capacity_for(std::size_t bytes) {
+  const std::size_t granule = bytes >= HUGE_PAGE_BYTES ? HUGE_PAGE_BYTES : 4096;
+  return (bytes + granule - 1) / granule * granule;
+}
+
+// whether the current thread bypasses the pool (see BufferPool::Bypass)
+thread_local bool bypassing = false;
+
+// allocate a new buffer of a capacity from capacity_for
+void *allocate(std::size_t capacity) {
+  const bool huge = capacity >= HUGE_PAGE_BYTES;
+  void *buffer = std::aligned_alloc(huge ? HUGE_PAGE_BYTES : BUFFER_ALIGNMENT, capacity);
+  if (buffer == nullptr) throw std::bad_alloc();
+  if (huge) {
+    // only a hint: without transparent huge pages this fails and the buffer uses normal pages
+    madvise(buffer, capacity, MADV_HUGEPAGE);
+  }
+  return buffer;
+}
+} // namespace
+
+BufferPool::Bypass::Bypass() : was_bypassing(bypassing) {
+  bypassing = true;
+}
+
+BufferPool::Bypass::~Bypass() {
+  bypassing = was_bypassing;
+}
+
+std::string BufferPoolStats::to_json() const {
+  std::stringstream ss;
+  ss << "{";
+  ss << "\"hits\": " << hits << ",";
+  ss << "\"misses\": " << misses << ",";
+  ss << "\"idle_bytes\": " << idle_bytes << ",";
+  ss << "\"huge_page_buffers\": " << huge_page_buffers << ",";
+  ss << "\"in_use_bytes\": " << in_use_bytes << ",";
+  ss << "\"peak_in_use_bytes\": " << peak_in_use_bytes;
+  ss << "}";
+  return ss.str();
+}
+
+BufferPool &BufferPool::shared() {
+  static BufferPool *pool = new BufferPool();
+  return *pool;
+}
+
+void *BufferPool::acquire(std::size_t bytes) {
+  if (bytes < POOL_MIN_BYTES) {
+    return ::operator new(bytes, std::align_val_t{BUFFER_ALIGNMENT});
+  }
+  const std::size_t capacity = capacity_for(bytes);
+  const std::size_t now_in_use = in_use.fetch_add(capacity) + capacity;
+  // raise the high-water mark, unless another thread raised it further meanwhile
+  std::size_t peak = peak_in_use.load();
+  while (peak < now_in_use && !peak_in_use.compare_exchange_weak(peak, now_in_use)) {
+  }
+  // buffers are allocated the same way either way, so one from the pool may be freed directly
+  // and one allocated directly may be released into the pool
+  if (bypassing) return allocate(capacity);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = idle.find(capacity);
+    if (it != idle.end() && !it->second.empty()) {
+      void *buffer = it->second.back();
+      it->second.pop_back();
+      counters.idle_bytes -= capacity;
+      counters.hits++;
+      return buffer;
+    }
+    counters.misses++;
+    if (capacity >= HUGE_PAGE_BYTES) counters.huge_page_buffers++;
+  }
+  return allocate(capacity);
+}
+
+void BufferPool::release(void *buffer, std::size_t bytes) {
+  if (buffer == nullptr) return;
+  if (bytes < POOL_MIN_BYTES) {
+    ::operator delete(buffer, std::align_val_t{BUFFER_ALIGNMENT});
+    return;
+  }
+  const std::size_t capacity = capacity_for(bytes);
+  in_use.fetch_sub(capacity);
+  if (!bypassing) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (counters.idle_bytes + capacity <= POOL_MAX_IDLE_BYTES) {
+      idle[capacity].push_back(buffer);
+      counters.idle_bytes += capacity;
+      return;
+    }
+  }
+  std::free(buffer);
+}
+
+void BufferPool::trim() {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto &[capacity, buffers] : idle) {
+    for (void *buffer : buffers) std::free(buffer);
+  }
+  idle.clear();
+  counters.idle_bytes = 0;
+  // without this, the allocator may keep the freed memory mapped and so resident
+  malloc_trim(0);
+}
+
+void BufferPool::reset_peak() {
+  peak_in_use.store(in_use.load());
+}
+
+BufferPoolStats BufferPool::stats() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  BufferPoolStats stats = counters;
+  stats.in_use_bytes = in_use.load();
+  stats.peak_in_use_bytes = peak_in_use.load();
+  return stats;
+}
+
+} // namespace ca
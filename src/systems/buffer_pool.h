@@ -0,0 +1,108 @@
+// Defines a process-wide pool of aligned buffers that are recycled between jobs and sweep points,
+// so that once every buffer size has been seen, running a job allocates nothing from the heap.
+// Buffers large enough to span huge pages are aligned to them and advised to use them.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ca {
+
+// alignment of every pooled buffer (a cache line, and enough for any vector load)
+constexpr std::size_t BUFFER_ALIGNMENT = 64;
+// buffers of at least this size are aligned to it and use transparent huge pages if available
+constexpr std::size_t HUGE_PAGE_BYTES = 2 << 20;
+// smaller buffers bypass the pool: they are cheap to allocate, and most are scratch rows
+constexpr std::size_t POOL_MIN_BYTES = 64 << 10;
+// idle buffers beyond this many bytes are returned to the system instead of being kept
+constexpr std::size_t POOL_MAX_IDLE_BYTES = std::size_t{1} << 30;
+
+struct BufferPoolStats {
+  // pooled allocations served from an idle buffer, and ones that had to allocate
+  unsigned long hits{0};
+  unsigned long misses{0};
+  // bytes held by idle buffers
+  unsigned long idle_bytes{0};
+  // buffers allocated with huge page alignment
+  unsigned long huge_page_buffers{0};
+  // bytes of pooled buffers handed out and not yet released, and the most there were since the
+  // last BufferPool::reset_peak. unlike the resident set size, these leave out idle buffers.
+  unsigned long in_use_bytes{0};
+  unsigned long peak_in_use_bytes{0};
+
+  std::string to_json() const;
+};
+
+// Thread-safe, so the workers of a job-parallel run can share it.
+class BufferPool {
+public:
+  // While one is alive, pooled allocations on the thread that made it skip the idle buffers, and
+  // buffers it releases are freed. A recycled buffer keeps its pages on the NUMA node that first
+  // touched them, so threads that want their memory placed on their own node bypass the pool.
+  class Bypass {
+  public:
+    Bypass();
+    ~Bypass();
+    Bypass(const Bypass &) = delete;
+    Bypass &operator=(const Bypass &) = delete;
+
+  private:
+    bool was_bypassing;
+  };
+
+  // the pool used by PoolAllocator. it is never destroyed, so vectors in other static objects
+  // may still release into it at exit.
+  static BufferPool &shared();
+
+  /**
+   * @brief get a buffer of at least the given size, aligned to BUFFER_ALIGNMENT (or to
+   * HUGE_PAGE_BYTES for buffers at least that large). the contents are unspecified.
+   */
+  void *acquire(std::size_t bytes);
+  // give back a buffer from acquire, with the size it was acquired with
+  void release(void *buffer, std::size_t bytes);
+  // free every idle buffer, and return the freed memory to the system
+  void trim();
+  // restart the high-water mark of the bytes handed out from the bytes handed out now
+  void reset_peak();
+
+  BufferPoolStats stats() const;
+
+private:
+  mutable std::mutex mutex;
+  // idle buffers by their capacity
+  std::unordered_map<std::size_t, std::vector<void *>> idle;
+  BufferPoolStats counters;
+  // updated outside the mutex, so they are kept apart from the counters
+  std::atomic<std::size_t> in_use{0};
+  std::atomic<std::size_t> peak_in_use{0};
+};
+
+// Stateless allocator drawing from BufferPool::shared(), for containers that hold world state.
+template <typename T>
+struct PoolAllocator {
+  using value_type = T;
+
+  PoolAllocator() = default;
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U> &) {}
+
+  T *allocate(std::size_t n) {
+    return static_cast<T *>(BufferPool::shared().acquire(n * sizeof(T)));
+  }
+  void deallocate(T *p, std::size_t n) { BufferPool::shared().release(p, n * sizeof(T)); }
+
+  template <typename U>
+  bool operator==(const PoolAllocator<U> &) const {
+    return true;
+  }
+};
+
+template <typename T>
+using pooled_vector = std::vector<T, PoolAllocator<T>>;
+
+} // namespace ca
@@ -0,0 +1,54 @@
+// Defines detection of still lifes and oscillators from the per-generation reductions the
+// counting kernels produce (see StepStats), so runs that settle early can stop or skip ahead.
+#include "cycle_detection.h"
+
+#include <stdexcept>
+
+namespace ca {
+
+CycleMode parse_cycle_mode(const std::string &text) {
+  if (text == "off") return CycleMode::OFF;
+  if (text == "detect") return CycleMode::DETECT;
+  if (text == "stop") return CycleMode::STOP;
+  if (text == "fast_forward") return CycleMode::FAST_FORWARD;
+  throw std::invalid_argument("unknown cycle mode '" + text +
+                              "' (expected off, detect, stop or fast_forward)");
+}
+
+std::string to_string(CycleMode mode) {
+  switch (mode) {
+  case CycleMode::DETECT:
+    return "detect";
+  case CycleMode::STOP:
+    return "stop";
+  case CycleMode::FAST_FORWARD:
+    return "fast_forward";
+  default:
+    return "off";
+  }
+}
+
+CycleDetector::CycleDetector(int max_period) : max_period(max_period), recent(max_period) {}
+
+int CycleDetector::observe(long generation, const StepStats &stats) {
+  int period = 0;
+  if (stats.changed == 0) {
+    // nothing changed in this step, which needs no hash to be sure of
+    period = 1;
+  } else {
+    // the smallest period wins: p * k also matches for any multiple of the true period p
+    const long available = observed < max_period ? observed : max_period;
+    for (long p = 1; p <= available; p++) {
+      const StepStats &old = recent[(generation - p) % max_period];
+      if (old.hash == stats.hash && old.population == stats.population) {
+        period = static_cast<int>(p);
+        break;
+      }
+    }
+  }
+  recent[generation % max_period] = stats;
+  observed++;
+  return period;
+}
+
+} // namespace ca
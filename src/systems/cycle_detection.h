@@ -0,0 +1,106 @@
+// Defines detection of still lifes and oscillators from the per-generation reductions the
+// counting kernels produce (see StepStats), so runs that settle early can stop or skip ahead.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bit_world.h"
+
+namespace ca {
+
+// longest period that is looked for (covers the common soup oscillators, which have periods of
+// at most 15, with room for longer ones)
+constexpr int CYCLE_MAX_PERIOD = 64;
+
+// what an engine does with the reductions of each generation
+enum class CycleMode {
+  // plain update, no reductions
+  OFF,
+  // reduce and detect cycles, but always run every generation
+  DETECT,
+  // stop at the first repeated state. the final state is then that of stop_generation.
+  STOP,
+  // once a cycle is found, only run the generations needed to land on the same phase the
+  // requested generation would have. the final state is exact.
+  FAST_FORWARD,
+};
+
+// parse "off", "detect", "stop" or "fast_forward". throws std::invalid_argument otherwise.
+CycleMode parse_cycle_mode(const std::string &text);
+std::string to_string(CycleMode mode);
+
+// outcome of cycle detection over a run
+struct CycleInfo {
+  // period of the cycle the world settled into (1 for a still life), 0 if none was found
+  int period{0};
+  // first generation seen in the cycle (the state at first_seen + period repeats it)
+  long first_seen{-1};
+  // number of generations that were actually computed
+  long stop_generation{-1};
+  // whether the final state is not that of the requested generation (CycleMode::STOP)
+  bool stopped_early{false};
+};
+
+// Keeps the hash and population of the last CYCLE_MAX_PERIOD generations and reports when the
+// newest one repeats an earlier one. States are compared by their 64-bit StepStats::hash and
+// population only, so a false match is possible in principle, but not in practice. A step that
+// changes no cell is recognized exactly, as a still life.
+class CycleDetector {
+public:
+  explicit CycleDetector(int max_period = CYCLE_MAX_PERIOD);
+
+  /**
+   * @brief add the reductions of one generation
+   *
+   * @param generation the generation the stats describe (generations must be consecutive)
+   * @param stats the reductions of that generation's state
+   * @return the period if this state repeats one of the last max_period states, 0 otherwise
+   */
+  int observe(long generation, const StepStats &stats);
+
+private:
+  int max_period;
+  // ring of the most recent states, indexed by generation % max_period
+  std::vector<StepStats> recent;
+  long observed{0};
+};
+
+/**
+ * @brief run a world with the given step function, detecting cycles as configured
+ *
+ * @param iterations requested number of generations
+ * @param mode what to do once a cycle is found (not OFF)
+ * @param step advances the world by one generation and returns the StepStats of the new state
+ * @param after_step called with the generation number after every step (tracing, recording)
+ */
+template <typename Step, typename AfterStep>
+CycleInfo run_with_cycle_detection(long iterations, CycleMode mode, Step step,
+                                   AfterStep after_step) {
+  CycleDetector detector;
+  CycleInfo info;
+  long end = iterations;
+  long generation = 0;
+  while (generation < end) {
+    const StepStats stats = step();
+    generation++;
+    after_step(generation);
+    if (info.period != 0) continue;
+    const int period = detector.observe(generation, stats);
+    if (period == 0) continue;
+    info.period = period;
+    info.first_seen = generation - period;
+    if (mode == CycleMode::STOP) {
+      end = generation;
+      info.stopped_early = generation < iterations;
+    } else if (mode == CycleMode::FAST_FORWARD) {
+      // the state at `iterations` is the one (iterations - generation) % period steps ahead
+      end = generation + (iterations - generation) % period;
+    }
+  }
+  info.stop_generation = generation;
+  return info;
+}
+
+} // namespace ca
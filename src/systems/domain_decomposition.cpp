@@ -0,0 +1,385 @@
+// Defines a multi-process engine that splits the world into a 2D grid of subdomains, each run
+// by its own forked process. Neighboring subdomains exchange their boundary cells through ring
+// buffers in POSIX shared memory, and the exchange overlaps with the interior computation. This
+// prototypes the layout a multi-node version would use, with processes standing in for nodes.
+#include "domain_decomposition.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "halo_world.h"
+#include "memory_usage.h"
+
+namespace ca {
+
+namespace {
+// the eight neighbor directions. a message sent in direction d carries the sender's boundary
+// cells on that side, and fills the receiver's ghost cells on the opposite side.
+constexpr int NUM_DIRECTIONS = 8;
+constexpr int DX[NUM_DIRECTIONS] = {0, 0, -1, 1, -1, 1, -1, 1};
+constexpr int DY[NUM_DIRECTIONS] = {-1, 1, 0, 0, -1, -1, 1, 1};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "the ring buffers need address-free atomics to be shared between processes");
+
+// single producer, single consumer ring of HALO_RING_SLOTS messages. the slots follow the
+// headers in the shared region. head and tail count messages, and live on separate cache lines
+// since they are written by different processes.
+struct RingHeader {
+  alignas(64) std::atomic<std::uint64_t> head{0};
+  alignas(64) std::atomic<std::uint64_t> tail{0};
+};
+
+struct Control {
+  // processes that reached the start barrier
+  alignas(64) std::atomic<int> ready{0};
+  // set by a failing process, so the others stop waiting for it
+  alignas(64) std::atomic<int> failed{0};
+};
+
+struct ProcessTimes {
+  double seconds;
+  double compute_seconds;
+  double comm_seconds;
+  // peak resident set size of the process, in bytes
+  unsigned long peak_rss;
+};
+
+size_t align_up(size_t n) {
+  return (n + 63) / 64 * 64;
+}
+
+// where everything lives in the shared region
+struct Layout {
+  size_t control{0};
+  size_t times{0};
+  size_t rings{0};
+  size_t slots{0};
+  size_t result{0};
+  size_t total{0};
+  size_t slot_bytes{0};
+
+  Layout(int processes, size_t slot_bytes, size_t world_cells) : slot_bytes(slot_bytes) {
+    times = align_up(sizeof(Control));
+    rings = align_up(times + processes * sizeof(ProcessTimes));
+    slots = align_up(rings + static_cast<size_t>(processes) * NUM_DIRECTIONS * sizeof(RingHeader));
+    result = align_up(slots + static_cast<size_t>(processes) * NUM_DIRECTIONS * HALO_RING_SLOTS *
+                                  slot_bytes);
+    total = align_up(result + world_cells);
+  }
+};
+
+// rectangle of the world owned by one process
+struct Subdomain {
+  int x, y, width, height;
+};
+
+[[noreturn]] void fail(const std::string &what) {
+  throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+// state of one process
+class Worker {
+public:
+  Worker(char *shared, const Layout &layout, int index, int domains_x, int domains_y,
+         const std::vector<Subdomain> &domains, const World &world)
+      : shared(shared), layout(layout), index(index), domains_x(domains_x), domains_y(domains_y),
+        domain(domains[index]), world_width(world.width),
+        control(reinterpret_cast<Control *>(shared + layout.control)) {
+    // copy this process's part of the world into a halo-padded buffer
+    World part;
+    part.width = domain.width;
+    part.height = domain.height;
+    part.state.resize(static_cast<size_t>(domain.width) * domain.height);
+    for (int y = 0; y < domain.height; y++) {
+      const cell_t *src = &world.state[static_cast<size_t>(domain.y + y) * world.width + domain.x];
+      std::copy_n(src, domain.width, &part.state[static_cast<size_t>(y) * domain.width]);
+    }
+    read = HaloWorld(part);
+    write = read;
+  }
+
+  void run(int iterations, Rule rule) {
+    // start together, so the times are comparable
+    control->ready.fetch_add(1, std::memory_order_acq_rel);
+    const int processes = domains_x * domains_y;
+    wait_until([&] { return control->ready.load(std::memory_order_acquire) == processes; });
+
+    const auto start = std::chrono::steady_clock::now();
+    auto last = start;
+    // charge the time since the last call to compute or comm
+    auto lap = [&](double &total) {
+      const auto now = std::chrono::steady_clock::now();
+      total += std::chrono::duration<double>(now - last).count();
+      last = now;
+    };
+
+    const int w = domain.width;
+    const int h = domain.height;
+    double compute = 0, comm = 0;
+    send_boundaries(0);
+    lap(comm);
+    for (int t = 0; t < iterations; t++) {
+      // the cells that only depend on this process's own cells, while the halo is in flight
+      if (w > 2 && h > 2) update_halo_state(read, write, rule, 1, h - 1, 1, w - 1);
+      lap(compute);
+      receive_halo(t);
+      lap(comm);
+      // the boundary ring, which needs the halo
+      update_halo_state(read, write, rule, 0, 1, 0, w);
+      if (h > 1) update_halo_state(read, write, rule, h - 1, h, 0, w);
+      if (h > 2) {
+        update_halo_state(read, write, rule, 1, h - 1, 0, 1);
+        if (w > 1) update_halo_state(read, write, rule, 1, h - 1, w - 1, w);
+      }
+      std::swap(read.state, write.state);
+      lap(compute);
+      if (t + 1 < iterations) send_boundaries(t + 1);
+      lap(comm);
+    }
+    const double seconds = std::chrono::duration<double>(last - start).count();
+
+    // publish the final state and the times
+    World final_state = read.to_world();
+    char *result = shared + layout.result;
+    for (int y = 0; y < h; y++) {
+      std::copy_n(&final_state.state[static_cast<size_t>(y) * w], w,
+                  result + static_cast<size_t>(domain.y + y) * world_width + domain.x);
+    }
+    reinterpret_cast<ProcessTimes *>(shared + layout.times)[index] =
+        ProcessTimes{seconds, compute, comm, peak_rss()};
+  }
+
+private:
+  template <typename Ready>
+  void wait_until(Ready ready) {
+    // spin briefly, then yield: there may be more processes than cores
+    int spins = 0;
+    while (!ready()) {
+      if (control->failed.load(std::memory_order_relaxed)) {
+        throw std::runtime_error("another subdomain process failed");
+      }
+      if (++spins > 1024) sched_yield();
+    }
+  }
+
+  RingHeader &ring(int process, int direction) {
+    auto *rings = reinterpret_cast<RingHeader *>(shared + layout.rings);
+    return rings[process * NUM_DIRECTIONS + direction];
+  }
+
+  char *slot(int process, int direction, std::uint64_t message_index) {
+    const size_t ring_index = static_cast<size_t>(process) * NUM_DIRECTIONS + direction;
+    return shared + layout.slots +
+           (ring_index * HALO_RING_SLOTS + message_index % HALO_RING_SLOTS) * layout.slot_bytes;
+  }
+
+  // index of the process at an offset from this one, wrapping around the grid
+  int neighbor(int dx, int dy) const {
+    const int x = (index % domains_x + dx + domains_x) % domains_x;
+    const int y = (index / domains_x + dy + domains_y) % domains_y;
+    return y * domains_x + x;
+  }
+
+  // send this process's boundary cells of generation t to all eight neighbors
+  void send_boundaries(std::uint64_t t) {
+    const int w = domain.width;
+    const int h = domain.height;
+    for (int d = 0; d < NUM_DIRECTIONS; d++) {
+      RingHeader &r = ring(index, d);
+      // wait for a free slot
+      wait_until([&] { return t - r.tail.load(std::memory_order_acquire) < HALO_RING_SLOTS; });
+      char *out = slot(index, d, t);
+      // the row or column on side d (a single cell for the corners), in interior coordinates
+      const int x = DX[d] < 0 ? 0 : w - 1;
+      const int y = DY[d] < 0 ? 0 : h - 1;
+      if (DY[d] != 0 && DX[d] == 0) {
+        std::copy_n(&read.state[static_cast<size_t>(y + 1) * read.stride + 1], w, out);
+      } else if (DX[d] != 0 && DY[d] == 0) {
+        for (int i = 0; i < h; i++) {
+          out[i] = read.state[static_cast<size_t>(i + 1) * read.stride + x + 1];
+        }
+      } else {
+        out[0] = read.state[static_cast<size_t>(y + 1) * read.stride + x + 1];
+      }
+      r.head.store(t + 1, std::memory_order_release);
+    }
+  }
+
+  // fill the ghost cells with the neighbors' boundary cells of generation t
+  void receive_halo(std::uint64_t t) {
+    const int w = domain.width;
+    const int h = domain.height;
+    for (int d = 0; d < NUM_DIRECTIONS; d++) {
+      // a message travelling in direction d comes from the neighbor on the opposite side
+      const int sender = neighbor(-DX[d], -DY[d]);
+      RingHeader &r = ring(sender, d);
+      wait_until([&] { return r.head.load(std::memory_order_acquire) > t; });
+      const char *in = slot(sender, d, t);
+      // the ghost row or column on the side opposite to d, in padded coordinates
+      const int x = DX[d] < 0 ? w + 1 : 0;
+      const int y = DY[d] < 0 ? h + 1 : 0;
+      if (DY[d] != 0 && DX[d] == 0) {
+        std::copy_n(in, w, &read.state[static_cast<size_t>(y) * read.stride + 1]);
+      } else if (DX[d] != 0 && DY[d] == 0) {
+        for (int i = 0; i < h; i++) {
+          read.state[static_cast<size_t>(i + 1) * read.stride + x] = in[i];
+        }
+      } else {
+        read.state[static_cast<size_t>(y) * read.stride + x] = in[0];
+      }
+      r.tail.store(t + 1, std::memory_order_release);
+    }
+  }
+
+  char *shared;
+  const Layout &layout;
+  int index;
+  int domains_x;
+  int domains_y;
+  Subdomain domain;
+  int world_width;
+  Control *control;
+  HaloWorld read;
+  HaloWorld write;
+};
+
+// a POSIX shared memory region, unlinked as soon as it is mapped: forked processes inherit the
+// mapping, and nothing is left behind in /dev/shm if the program dies
+class SharedRegion {
+public:
+  explicit SharedRegion(size_t size) : size(size) {
+    static std::atomic<int> counter{0};
+    const std::string name =
+        "/ca_domains_" + std::to_string(getpid()) + "_" + std::to_string(counter++);
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) fail("shm_open " + name);
+    shm_unlink(name.c_str());
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      close(fd);
+      fail("ftruncate " + name);
+    }
+    void *mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) fail("mmap " + name);
+    data = static_cast<char *>(mapped);
+  }
+  ~SharedRegion() { munmap(data, size); }
+
+  SharedRegion(const SharedRegion &) = delete;
+  SharedRegion &operator=(const SharedRegion &) = delete;
+
+  char *data;
+  size_t size;
+};
+} // namespace
+
+DecomposedRun run_decomposed(const World &world, int iterations, Rule rule, int domains_x,
+                             int domains_y) {
+  // every subdomain holds at least one cell
+  domains_x = std::clamp(domains_x, 1, world.width);
+  domains_y = std::clamp(domains_y, 1, world.height);
+  const int processes = domains_x * domains_y;
+  std::vector<Subdomain> domains;
+  int longest_edge = 1;
+  for (int j = 0; j < domains_y; j++) {
+    for (int i = 0; i < domains_x; i++) {
+      const int x0 = static_cast<int>(static_cast<long>(world.width) * i / domains_x);
+      const int x1 = static_cast<int>(static_cast<long>(world.width) * (i + 1) / domains_x);
+      const int y0 = static_cast<int>(static_cast<long>(world.height) * j / domains_y);
+      const int y1 = static_cast<int>(static_cast<long>(world.height) * (j + 1) / domains_y);
+      domains.push_back(Subdomain{x0, y0, x1 - x0, y1 - y0});
+      longest_edge = std::max({longest_edge, x1 - x0, y1 - y0});
+    }
+  }
+
+  const size_t cells = static_cast<size_t>(world.width) * world.height;
+  const Layout layout(processes, align_up(longest_edge), cells);
+  SharedRegion region(layout.total);
+  new (region.data + layout.control) Control();
+  auto *rings = reinterpret_cast<RingHeader *>(region.data + layout.rings);
+  for (int i = 0; i < processes * NUM_DIRECTIONS; i++) {
+    new (&rings[i]) RingHeader();
+  }
+  Control *control = reinterpret_cast<Control *>(region.data + layout.control);
+
+  std::vector<pid_t> children;
+  auto stop_children = [&] {
+    control->failed.store(1);
+    for (pid_t child : children) kill(child, SIGKILL);
+    for (pid_t child : children) waitpid(child, nullptr, 0);
+  };
+  for (int index = 0; index < processes; index++) {
+    const pid_t pid = fork();
+    if (pid < 0) {
+      const int error = errno;
+      stop_children();
+      errno = error;
+      fail("fork");
+    }
+    if (pid == 0) {
+      // the child runs its subdomain and exits without returning into the caller
+      int status = 0;
+      try {
+        Worker worker(region.data, layout, index, domains_x, domains_y, domains, world);
+        worker.run(iterations, rule);
+      } catch (...) {
+        control->failed.store(1);
+        status = 1;
+      }
+      _exit(status);
+    }
+    children.push_back(pid);
+  }
+
+  // wait for every child. if one fails, the others are stopped rather than left spinning.
+  bool failed = false;
+  for (size_t remaining = children.size(); remaining > 0; remaining--) {
+    int status = 0;
+    const pid_t pid = waitpid(-1, &status, 0);
+    if (pid < 0) {
+      failed = true;
+      break;
+    }
+    children.erase(std::remove(children.begin(), children.end(), pid), children.end());
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      failed = true;
+      break;
+    }
+  }
+  if (failed) {
+    stop_children();
+    throw std::runtime_error("a subdomain process failed");
+  }
+
+  DecomposedRun run;
+  run.domains_x = domains_x;
+  run.domains_y = domains_y;
+  run.final_state.width = world.width;
+  run.final_state.height = world.height;
+  run.final_state.state.assign(region.data + layout.result, region.data + layout.result + cells);
+  const auto *times = reinterpret_cast<const ProcessTimes *>(region.data + layout.times);
+  for (int i = 0; i < processes; i++) {
+    run.seconds = std::max(run.seconds, times[i].seconds);
+    run.compute_seconds += times[i].compute_seconds / processes;
+    run.comm_seconds += times[i].comm_seconds / processes;
+    run.child_peak_rss += times[i].peak_rss;
+  }
+  return run;
+}
+
+} // namespace ca
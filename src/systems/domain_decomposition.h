@@ -0,0 +1,54 @@
+// Defines a multi-process engine that splits the world into a 2D grid of subdomains, each run
+// by its own forked process. Neighboring subdomains exchange their boundary cells through ring
+// buffers in POSIX shared memory, and the exchange overlaps with the interior computation. This
+// prototypes the layout a multi-node version would use, with processes standing in for nodes.
+#pragma once
+
+#include <cstdint>
+
+#include "rule.h"
+#include "types.h"
+
+namespace ca {
+
+// default grid of subdomains
+constexpr int DOMAINS_X = 2;
+constexpr int DOMAINS_Y = 2;
+// generations a sender may run ahead of the slowest of its receivers
+constexpr int HALO_RING_SLOTS = 4;
+
+// final state and timings of a decomposed run
+struct DecomposedRun {
+  World final_state;
+  // wall clock time of the slowest process, from the start barrier to its last generation
+  double seconds{0};
+  // time spent computing and exchanging halos (sending, and waiting for neighbors), averaged over
+  // the processes
+  double compute_seconds{0};
+  double comm_seconds{0};
+  // the grid actually used (clamped so that every subdomain holds at least one cell)
+  int domains_x{0};
+  int domains_y{0};
+  // sum of the peak resident set sizes of the processes. pages shared between them (the parent's
+  // memory inherited by fork, the shared region) are counted once per process that touched them.
+  unsigned long child_peak_rss{0};
+};
+
+/**
+ * @brief run a world on a grid of subdomains, one forked process each
+ *
+ * the world wraps around (is toroidal), like the single process engines. every generation, each
+ * process computes the cells that do not depend on its neighbors while their boundary cells
+ * arrive, then the cells along its own boundary, which it sends on for the next generation.
+ * throws std::runtime_error if the shared memory cannot be set up or a process fails.
+ *
+ * @param world the initial state
+ * @param iterations number of generations
+ * @param rule the rule to apply
+ * @param domains_x subdomains across
+ * @param domains_y subdomains down
+ */
+DecomposedRun run_decomposed(const World &world, int iterations, Rule rule, int domains_x,
+                             int domains_y);
+
+} // namespace ca
@@ -0,0 +1,298 @@
+// Defines a software rasterizer that turns a world (byte-per-cell or bit-packed) into an RGBA
+// framebuffer in one pass, downsampling when the world has more cells than the view has pixels,
+// along with PPM and PNG writers so frames can be produced without a display.
+#include "framebuffer.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace ca {
+
+namespace {
+// opaque black and white, with alpha in the last byte (the high byte of a little-endian word)
+constexpr pixel_t DEAD_PIXEL = 0xff000000u;
+constexpr pixel_t LIVE_PIXEL = 0xffffffffu;
+
+pixel_t grey(unsigned level) {
+  return DEAD_PIXEL | level * 0x010101u;
+}
+
+// the cells [begin, begin + count) along one axis that a pixel covers. begin is wrapped into the
+// world, and begin + count may run past its end (the rest continues at 0).
+struct Span {
+  int begin;
+  int count;
+};
+
+std::vector<Span> pixel_spans(int pixels, int cells, double center, double zoom) {
+  std::vector<Span> spans(pixels);
+  const double first = center - pixels / (2 * zoom);
+  for (int p = 0; p < pixels; p++) {
+    const long a = static_cast<long>(std::floor(first + p / zoom));
+    const long b = std::max(a + 1, static_cast<long>(std::floor(first + (p + 1) / zoom)));
+    spans[p] = {static_cast<int>(((a % cells) + cells) % cells),
+                static_cast<int>(std::min<long>(b - a, cells))};
+  }
+  return spans;
+}
+
+// cell access for the byte-per-cell layout
+struct ByteCells {
+  const World &world;
+
+  bool alive(int y, int x) const {
+    return world.state[static_cast<size_t>(y) * world.width + x] != 0;
+  }
+  // living cells among [x, x + n) of row y, wrapping at the east edge
+  unsigned count(int y, int x, int n) const {
+    const cell_t *row = &world.state[static_cast<size_t>(y) * world.width];
+    const int first = std::min(n, world.width - x);
+    unsigned total = 0;
+    for (int i = 0; i < first; i++) total += row[x + i] != 0;
+    for (int i = 0; i < n - first; i++) total += row[i] != 0;
+    return total;
+  }
+};
+
+// cell access for the bit-packed layout
+struct BitCells {
+  const BitWorld &world;
+
+  bool alive(int y, int x) const {
+    const word_t *row = &world.words[static_cast<size_t>(y) * world.words_per_row];
+    return (row[x / CELLS_PER_WORD] >> (x % CELLS_PER_WORD)) & 1;
+  }
+  unsigned count(int y, int x, int n) const {
+    const word_t *row = &world.words[static_cast<size_t>(y) * world.words_per_row];
+    const int first = std::min(n, world.width - x);
+    return count_bits(row, x, x + first) + count_bits(row, 0, n - first);
+  }
+  // living cells among [begin, end) of a row, a word at a time
+  static unsigned count_bits(const word_t *row, int begin, int end) {
+    if (begin >= end) return 0;
+    const int first_word = begin / CELLS_PER_WORD;
+    const int last_word = (end - 1) / CELLS_PER_WORD;
+    const word_t first_mask = ~word_t{0} << (begin % CELLS_PER_WORD);
+    const word_t last_mask = ~word_t{0} >> (CELLS_PER_WORD - 1 - (end - 1) % CELLS_PER_WORD);
+    if (first_word == last_word) return std::popcount(row[first_word] & first_mask & last_mask);
+    unsigned total = std::popcount(row[first_word] & first_mask);
+    for (int w = first_word + 1; w < last_word; w++) total += std::popcount(row[w]);
+    return total + std::popcount(row[last_word] & last_mask);
+  }
+};
+
+template <typename Cells>
+void render(const Cells &cells, int world_width, int world_height, const Viewport &view,
+            Framebuffer &frame, ThreadPool *pool) {
+  const std::vector<Span> xs = pixel_spans(frame.width, world_width, view.center_x, view.zoom);
+  const std::vector<Span> ys = pixel_spans(frame.height, world_height, view.center_y, view.zoom);
+  // zoomed in, every pixel shows a single cell
+  const bool magnified = view.zoom >= 1;
+
+  auto draw_rows = [&](int py_begin, int py_end) {
+    std::vector<unsigned> counts(magnified ? 0 : frame.width);
+    for (int py = py_begin; py < py_end; py++) {
+      pixel_t *out = &frame.pixels[static_cast<size_t>(py) * frame.width];
+      const Span sy = ys[py];
+      if (magnified) {
+        for (int px = 0; px < frame.width; px++) {
+          out[px] = cells.alive(sy.begin, xs[px].begin) ? LIVE_PIXEL : DEAD_PIXEL;
+        }
+        continue;
+      }
+      // pool the cells under each pixel, one world row at a time
+      std::fill(counts.begin(), counts.end(), 0u);
+      for (int i = 0; i < sy.count; i++) {
+        const int y = (sy.begin + i) % world_height;
+        for (int px = 0; px < frame.width; px++) {
+          counts[px] += cells.count(y, xs[px].begin, xs[px].count);
+        }
+      }
+      for (int px = 0; px < frame.width; px++) {
+        if (view.pooling == Pooling::MAX) {
+          out[px] = counts[px] > 0 ? LIVE_PIXEL : DEAD_PIXEL;
+        } else {
+          const unsigned area = static_cast<unsigned>(xs[px].count) * sy.count;
+          out[px] = grey(counts[px] * 255 / area);
+        }
+      }
+    }
+  };
+
+  if (pool == nullptr || pool->size() <= 1) {
+    draw_rows(0, frame.height);
+    return;
+  }
+  const int num_threads = pool->size();
+  pool->run([&](int thread_index) {
+    draw_rows(static_cast<int>(static_cast<long>(frame.height) * thread_index / num_threads),
+              static_cast<int>(static_cast<long>(frame.height) * (thread_index + 1) / num_threads));
+  });
+}
+
+// PNG chunks are checksummed with CRC-32, and the zlib stream with Adler-32
+std::uint32_t crc32(const std::uint8_t *data, size_t n, std::uint32_t crc = 0) {
+  static const std::array<std::uint32_t, 256> table = [] {
+    std::array<std::uint32_t, 256> t{};
+    for (std::uint32_t i = 0; i < 256; i++) {
+      std::uint32_t c = i;
+      for (int k = 0; k < 8; k++) c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      t[i] = c;
+    }
+    return t;
+  }();
+  crc = ~crc;
+  for (size_t i = 0; i < n; i++) crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  return ~crc;
+}
+
+void put_u32_be(std::vector<std::uint8_t> &out, std::uint32_t value) {
+  for (int shift = 24; shift >= 0; shift -= 8) out.push_back((value >> shift) & 0xff);
+}
+
+void put_chunk(std::vector<std::uint8_t> &out, const char *type,
+               const std::vector<std::uint8_t> &data) {
+  put_u32_be(out, static_cast<std::uint32_t>(data.size()));
+  const size_t start = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  put_u32_be(out, crc32(&out[start], out.size() - start));
+}
+
+std::vector<std::uint8_t> encode_png(const Framebuffer &frame) {
+  // scanlines of RGB bytes, each preceded by filter type 0 (none)
+  std::vector<std::uint8_t> raw;
+  raw.reserve(static_cast<size_t>(frame.height) * (frame.width * 3 + 1));
+  for (int y = 0; y < frame.height; y++) {
+    raw.push_back(0);
+    for (int x = 0; x < frame.width; x++) {
+      const pixel_t p = frame.pixels[static_cast<size_t>(y) * frame.width + x];
+      raw.push_back(p & 0xff);
+      raw.push_back((p >> 8) & 0xff);
+      raw.push_back((p >> 16) & 0xff);
+    }
+  }
+
+  // zlib stream of stored deflate blocks (at most 65535 bytes each)
+  std::vector<std::uint8_t> zlib = {0x78, 0x01};
+  size_t offset = 0;
+  do {
+    const size_t n = std::min<size_t>(65535, raw.size() - offset);
+    // header byte: whether this is the final block, and block type 0 (stored)
+    zlib.push_back(offset + n == raw.size() ? 1 : 0);
+    zlib.push_back(n & 0xff);
+    zlib.push_back(n >> 8);
+    zlib.push_back(~n & 0xff);
+    zlib.push_back((~n >> 8) & 0xff);
+    zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + n);
+    offset += n;
+  } while (offset < raw.size());
+  std::uint32_t a = 1, b = 0;
+  for (std::uint8_t byte : raw) {
+    a = (a + byte) % 65521;
+    b = (b + a) % 65521;
+  }
+  put_u32_be(zlib, (b << 16) | a);
+
+  std::vector<std::uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  std::vector<std::uint8_t> header;
+  put_u32_be(header, frame.width);
+  put_u32_be(header, frame.height);
+  // 8 bits per channel, truecolor, default compression/filter, no interlace
+  header.insert(header.end(), {8, 2, 0, 0, 0});
+  put_chunk(png, "IHDR", header);
+  put_chunk(png, "IDAT", zlib);
+  put_chunk(png, "IEND", {});
+  return png;
+}
+} // namespace
+
+Viewport fit_viewport(int world_width, int world_height, int frame_width, int frame_height) {
+  Viewport view;
+  view.center_x = world_width / 2.0;
+  view.center_y = world_height / 2.0;
+  const double zoom = std::min(static_cast<double>(frame_width) / world_width,
+                               static_cast<double>(frame_height) / world_height);
+  view.zoom = zoom >= 1 ? std::floor(zoom) : zoom;
+  return view;
+}
+
+void render_frame(const World &world, const Viewport &view, Framebuffer &frame,
+                  ThreadPool *pool) {
+  render(ByteCells{world}, world.width, world.height, view, frame, pool);
+}
+
+void render_frame(const BitWorld &world, const Viewport &view, Framebuffer &frame,
+                  ThreadPool *pool) {
+  render(BitCells{world}, world.width, world.height, view, frame, pool);
+}
+
+void write_frame(const std::string &path, const Framebuffer &frame) {
+  std::ofstream file(path, std::ios::out | std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open file: " + path);
+  }
+  if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".png") == 0) {
+    const std::vector<std::uint8_t> png = encode_png(frame);
+    file.write(reinterpret_cast<const char *>(png.data()),
+               static_cast<std::streamsize>(png.size()));
+  } else {
+    file << "P6\n" << frame.width << " " << frame.height << "\n255\n";
+    std::vector<std::uint8_t> rgb(static_cast<size_t>(frame.width) * 3);
+    for (int y = 0; y < frame.height; y++) {
+      for (int x = 0; x < frame.width; x++) {
+        const pixel_t p = frame.pixels[static_cast<size_t>(y) * frame.width + x];
+        rgb[3 * x] = p & 0xff;
+        rgb[3 * x + 1] = (p >> 8) & 0xff;
+        rgb[3 * x + 2] = (p >> 16) & 0xff;
+      }
+      file.write(reinterpret_cast<const char *>(rgb.data()),
+                 static_cast<std::streamsize>(rgb.size()));
+    }
+  }
+  if (!file) throw std::runtime_error("Failed to write file: " + path);
+}
+
+HeadlessRenderer::HeadlessRenderer(int frame_size, const std::string &path, int world_width,
+                                   int world_height)
+    : path(path), view(fit_viewport(world_width, world_height, frame_size, frame_size)),
+      framebuffer(frame_size, frame_size) {}
+
+void HeadlessRenderer::render(const World &world, long generation) {
+  render_world(world, generation);
+}
+
+void HeadlessRenderer::render(const BitWorld &world, long generation) {
+  render_world(world, generation);
+}
+
+template <typename W>
+void HeadlessRenderer::render_world(const W &world, long generation) {
+  auto start = std::chrono::steady_clock::now();
+  render_frame(world, view, framebuffer);
+  auto drawn = std::chrono::steady_clock::now();
+  totals.frames++;
+  totals.render_seconds += std::chrono::duration<double>(drawn - start).count();
+  if (path.empty()) return;
+
+  // frame.png -> frame_000064.png
+  char number[32];
+  std::snprintf(number, sizeof(number), "_%06ld", generation);
+  const size_t dot = path.find_last_of('.');
+  const size_t slash = path.find_last_of('/');
+  const bool has_extension =
+      dot != std::string::npos && (slash == std::string::npos || dot > slash);
+  write_frame(has_extension ? path.substr(0, dot) + number + path.substr(dot) : path + number,
+              framebuffer);
+  totals.write_seconds +=
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - drawn).count();
+}
+
+} // namespace ca
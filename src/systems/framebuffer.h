@@ -0,0 +1,136 @@
+// Defines a software rasterizer that turns a world (byte-per-cell or bit-packed) into an RGBA
+// framebuffer in one pass, downsampling when the world has more cells than the view has pixels,
+// along with PPM and PNG writers so frames can be produced without a display.
+#pragma once
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include "bit_world.h"
+#include "buffer_pool.h"
+#include "thread_pool.h"
+#include "types.h"
+
+namespace ca {
+
+// pixels are stored as the bytes R, G, B, A (SDL_PIXELFORMAT_RGBA32)
+using pixel_t = std::uint32_t;
+
+struct Framebuffer {
+  int width{0};
+  int height{0};
+  pooled_vector<pixel_t> pixels;
+
+  Framebuffer() = default;
+  Framebuffer(int width, int height)
+      : width(width), height(height), pixels(static_cast<size_t>(width) * height) {}
+};
+
+// how the cells covered by one pixel are combined when zoomed out
+enum class Pooling {
+  // the pixel is lit if any of its cells is alive, so sparse patterns stay visible
+  MAX,
+  // the pixel's brightness is the fraction of its cells that are alive
+  DENSITY,
+};
+
+// The part of the world shown in the framebuffer. The world wraps around, so panning past an
+// edge shows the opposite one.
+struct Viewport {
+  // the cell at the center of the framebuffer
+  double center_x{0};
+  double center_y{0};
+  // pixels per cell. below 1, each pixel covers several cells (see Pooling).
+  double zoom{1};
+  Pooling pooling{Pooling::MAX};
+
+  // move the view by a number of pixels
+  void pan(double dx_pixels, double dy_pixels) {
+    center_x += dx_pixels / zoom;
+    center_y += dy_pixels / zoom;
+  }
+};
+
+/**
+ * @brief the viewport that shows a whole world_width x world_height world in the framebuffer
+ *
+ * whole pixels per cell when the world is smaller than the framebuffer, so cells stay square
+ */
+Viewport fit_viewport(int world_width, int world_height, int frame_width, int frame_height);
+
+/**
+ * @brief draw a world into a framebuffer
+ *
+ * @param world the world to draw
+ * @param view the part of the world to show
+ * @param frame the framebuffer to fill (every pixel is written)
+ * @param pool if given, bands of pixel rows are drawn by its threads
+ */
+void render_frame(const World &world, const Viewport &view, Framebuffer &frame,
+                  ThreadPool *pool = nullptr);
+// same as above, for a bit-packed world (zoomed out, the cells under a pixel are counted with
+// popcounts rather than one by one)
+void render_frame(const BitWorld &world, const Viewport &view, Framebuffer &frame,
+                  ThreadPool *pool = nullptr);
+
+/**
+ * @brief write a framebuffer as an image. throws std::runtime_error on failure.
+ *
+ * paths ending in .png get a PNG (with stored, uncompressed deflate blocks, so no compression
+ * library is needed), anything else a binary PPM (P6). the alpha channel is dropped.
+ */
+void write_frame(const std::string &path, const Framebuffer &frame);
+
+// what rendering cost during a run
+struct RenderStats {
+  std::uint64_t frames{0};
+  // time spent drawing frames, and writing them to files
+  double render_seconds{0};
+  double write_seconds{0};
+  // (render_seconds + write_seconds) as a fraction of the duration of the run (set by the
+  // benchmark)
+  double overhead{0};
+
+  std::string to_json() const {
+    std::stringstream ss;
+    ss << "{";
+    ss << "\"frames\": " << frames << ",";
+    ss << "\"render_seconds\": " << render_seconds << ",";
+    ss << "\"write_seconds\": " << write_seconds << ",";
+    ss << "\"overhead\": " << overhead;
+    ss << "}";
+    return ss.str();
+  }
+};
+
+// Renders frames of a run without a display, fitting the whole world into a square framebuffer,
+// and optionally writes each one to an image file.
+class HeadlessRenderer {
+public:
+  /**
+   * @brief prepare a frame_size x frame_size framebuffer for a world_width x world_height world
+   *
+   * @param path frames are written to this path with the generation appended to the name (e.g.
+   * frame.png becomes frame_000064.png). empty only renders, to measure the cost of drawing.
+   */
+  HeadlessRenderer(int frame_size, const std::string &path, int world_width, int world_height);
+
+  // draw a generation (and write it, if there is a path)
+  void render(const World &world, long generation);
+  void render(const BitWorld &world, long generation);
+
+  const Framebuffer &frame() const { return framebuffer; }
+  RenderStats stats() const { return totals; }
+
+private:
+  template <typename W>
+  void render_world(const W &world, long generation);
+
+  std::string path;
+  Viewport view;
+  Framebuffer framebuffer;
+  RenderStats totals;
+};
+
+} // namespace ca
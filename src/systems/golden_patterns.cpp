@@ -0,0 +1,57 @@
+// Defines a regression suite of well known patterns with the expected state digest after a set
+// number of generations, which every benchmark is checked against before it is timed.
+#include "golden_patterns.h"
+
+#include "world_io.h"
+
+namespace ca {
+
+namespace {
+constexpr const char *BLINKER = "x = 3, y = 1\n3o!";
+constexpr const char *GLIDER = "x = 3, y = 3\nbo$2bo$3o!";
+constexpr const char *GOSPER_GUN =
+    "x = 36, y = 9\n"
+    "24bo$22bobo$12b2o6b2o12b2o$11bo3bo4b2o12b2o$2o8bo5bo3b2o$2o8bo3bob2o4bobo$10bo5bo7bo$"
+    "11bo3bo$12b2o!";
+constexpr const char *R_PENTOMINO = "x = 3, y = 3\nb2o$2o$bo!";
+} // namespace
+
+const std::vector<GoldenPattern> &golden_patterns() {
+  // the expected digests were computed with the reference byte-per-cell engine (CPUNaive)
+  static const std::vector<GoldenPattern> patterns = {
+      {"blinker", BLINKER, 16, 16, 1, 0xbab9ffb0ea2f00c3ULL, 3},
+      {"blinker", BLINKER, 16, 16, 2, 0x162ff9561fcfdda2ULL, 3},
+      {"glider", GLIDER, 64, 64, 4, 0x1ca7fac8ca0758f2ULL, 5},
+      {"glider", GLIDER, 64, 64, 100, 0x260cfba11c9a429eULL, 5},
+      {"gosper_gun", GOSPER_GUN, 128, 128, 30, 0x28bf2c71333210d9ULL, 41},
+      {"gosper_gun", GOSPER_GUN, 128, 128, 120, 0xe1e1a44d555dc632ULL, 56},
+      {"r_pentomino", R_PENTOMINO, 256, 256, 100, 0xfbfd039e55cb1d81ULL, 121},
+      {"r_pentomino", R_PENTOMINO, 256, 256, 300, 0x95bf11dda543a27eULL, 168},
+  };
+  return patterns;
+}
+
+Job golden_job(const GoldenPattern &pattern) {
+  World world = place_pattern(parse_rle(pattern.rle, pattern.name).world, pattern.width,
+                              pattern.height);
+  return Job{std::move(world), pattern.generations,
+             std::string(pattern.name) + " @ " + std::to_string(pattern.generations), CONWAY};
+}
+
+std::vector<std::string> check_golden_patterns(Benchmark &benchmark) {
+  std::vector<std::string> failures;
+  for (const GoldenPattern &pattern : golden_patterns()) {
+    const Job job = golden_job(pattern);
+    const StateDigest expected{pattern.hash, pattern.population};
+    const StateDigest actual = benchmark.run(job).digest;
+    if (actual != expected) {
+      failures.push_back(job.description + ": expected " + expected.hash_string() + " (" +
+                         std::to_string(expected.population) + " cells), got " +
+                         actual.hash_string() + " (" + std::to_string(actual.population) +
+                         " cells)");
+    }
+  }
+  return failures;
+}
+
+} // namespace ca
@@ -0,0 +1,42 @@
+// Defines a regression suite of well known patterns with the expected state digest after a set
+// number of generations, which every benchmark is checked against before it is timed.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+
+namespace ca {
+
+// one pattern, run for a number of generations on a toroidal world of the given size under
+// Conway's rule. the patterns stay clear of the world's edges for that long, so the unbounded
+// engines agree with the toroidal ones.
+struct GoldenPattern {
+  const char *name;
+  // the pattern in RLE, placed in the center of the world
+  const char *rle;
+  int width;
+  int height;
+  int generations;
+  // digest of the world after that many generations
+  std::uint64_t hash;
+  std::uint64_t population;
+};
+
+// blinker, glider, Gosper glider gun and R-pentomino, each at two generations
+const std::vector<GoldenPattern> &golden_patterns();
+
+// the job that runs a golden pattern
+Job golden_job(const GoldenPattern &pattern);
+
+/**
+ * @brief run every golden pattern through a benchmark
+ *
+ * @param benchmark the benchmark to check
+ * @return one message per pattern whose digest did not match (empty if all of them did)
+ */
+std::vector<std::string> check_golden_patterns(Benchmark &benchmark);
+
+} // namespace ca
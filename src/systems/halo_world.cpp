@@ -0,0 +1,203 @@
+// Defines a halo-padded (ghost cell) representation of the cellular automata state, along with
+// a SIMD CPU update kernel that processes whole rows without per-neighbor modulo wrapping.
+#include "halo_world.h"
+
+#include <algorithm>
+
+#if defined(__AVX512BW__) || defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace ca {
+
+HaloWorld::HaloWorld(const World &world) {
+  width = world.width;
+  height = world.height;
+  stride = width + 2;
+  state.assign(static_cast<size_t>(stride) * (height + 2), 0);
+  for (int y = 0; y < height; y++) {
+    const cell_t *src = &world.state[static_cast<size_t>(y) * width];
+    cell_t *dst = &state[static_cast<size_t>(y + 1) * stride + 1];
+    // normalize to 0/1 so the kernel can count neighbors by adding bytes
+    for (int x = 0; x < width; x++) {
+      dst[x] = src[x] != 0;
+    }
+  }
+  refresh_halo();
+}
+
+World HaloWorld::to_world() const {
+  World world;
+  world.width = width;
+  world.height = height;
+  world.state.resize(static_cast<size_t>(width) * height);
+  for (int y = 0; y < height; y++) {
+    const cell_t *src = &state[static_cast<size_t>(y + 1) * stride + 1];
+    std::copy(src, src + width, &world.state[static_cast<size_t>(y) * width]);
+  }
+  return world;
+}
+
+void HaloWorld::refresh_halo() {
+  // ghost columns: left ghost gets the last column, right ghost gets the first column
+  for (int y = 1; y <= height; y++) {
+    cell_t *row = &state[static_cast<size_t>(y) * stride];
+    row[0] = row[width];
+    row[width + 1] = row[1];
+  }
+  // ghost rows (including corners, which the column pass above already filled in)
+  std::copy_n(&state[static_cast<size_t>(height) * stride], stride, &state[0]);
+  std::copy_n(&state[static_cast<size_t>(1) * stride], stride,
+              &state[static_cast<size_t>(height + 1) * stride]);
+}
+
+namespace {
+// scalar version of the rule, used for the tail of each row (and as the fallback kernel)
+inline void update_span_scalar(const cell_t *up, const cell_t *mid, const cell_t *down,
+                               cell_t *out, int begin, int end, Rule rule) {
+  // index by alive so that there is no branch per cell
+  const unsigned masks[2] = {rule.birth, rule.survival};
+  for (int x = begin; x < end; x++) {
+    int count = up[x - 1] + up[x] + up[x + 1] + mid[x - 1] + mid[x + 1] + down[x - 1] +
+                down[x] + down[x + 1];
+    out[x] = (masks[mid[x] != 0] >> count) & 1;
+  }
+}
+
+/**
+ * @brief update one padded row. pointers point to the ghost cell at the start of each row.
+ *
+ * @param up the row above
+ * @param mid the row being updated
+ * @param down the row below
+ * @param out destination row
+ * @param x_begin first padded column to update (1 is the first interior cell)
+ * @param x_end one past the last padded column to update
+ * @param rule the rule to apply
+ */
+void update_row(const cell_t *up, const cell_t *mid, const cell_t *down, cell_t *out,
+                int x_begin, int x_end, Rule rule) {
+  int x = x_begin;
+#if defined(__AVX512BW__) || defined(__AVX2__)
+  // per-count lookup tables (count 0..8, padded to 16 entries) for byte shuffles
+  alignas(64) cell_t birth_table[64] = {};
+  alignas(64) cell_t survival_table[64] = {};
+  for (int lane = 0; lane < 64; lane += 16) {
+    for (int k = 0; k <= 8; k++) {
+      birth_table[lane + k] = (rule.birth >> k) & 1;
+      survival_table[lane + k] = (rule.survival >> k) & 1;
+    }
+  }
+#endif
+#if defined(__AVX512BW__)
+  const __m512i birth = _mm512_load_si512(birth_table);
+  const __m512i survival = _mm512_load_si512(survival_table);
+  for (; x + 64 <= x_end; x += 64) {
+    auto load = [](const cell_t *p) { return _mm512_loadu_si512(p); };
+    __m512i count = _mm512_add_epi8(load(up + x - 1), load(up + x));
+    count = _mm512_add_epi8(count, load(up + x + 1));
+    count = _mm512_add_epi8(count, load(mid + x - 1));
+    count = _mm512_add_epi8(count, load(mid + x + 1));
+    count = _mm512_add_epi8(count, load(down + x - 1));
+    count = _mm512_add_epi8(count, load(down + x));
+    count = _mm512_add_epi8(count, load(down + x + 1));
+    __m512i alive = load(mid + x);
+    // look up the next state for each count, then pick the birth or survival entry
+    __m512i born = _mm512_shuffle_epi8(birth, count);
+    __m512i survives = _mm512_shuffle_epi8(survival, count);
+    _mm512_storeu_si512(out + x,
+                        _mm512_mask_blend_epi8(_mm512_test_epi8_mask(alive, alive), born, survives));
+  }
+#elif defined(__AVX2__)
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i birth = _mm256_load_si256(reinterpret_cast<const __m256i *>(birth_table));
+  const __m256i survival = _mm256_load_si256(reinterpret_cast<const __m256i *>(survival_table));
+  for (; x + 32 <= x_end; x += 32) {
+    auto load = [](const cell_t *p) {
+      return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    };
+    __m256i count = _mm256_add_epi8(load(up + x - 1), load(up + x));
+    count = _mm256_add_epi8(count, load(up + x + 1));
+    count = _mm256_add_epi8(count, load(mid + x - 1));
+    count = _mm256_add_epi8(count, load(mid + x + 1));
+    count = _mm256_add_epi8(count, load(down + x - 1));
+    count = _mm256_add_epi8(count, load(down + x));
+    count = _mm256_add_epi8(count, load(down + x + 1));
+    __m256i dead = _mm256_cmpeq_epi8(load(mid + x), zero);
+    // look up the next state for each count, then pick the birth or survival entry
+    __m256i born = _mm256_shuffle_epi8(birth, count);
+    __m256i survives = _mm256_shuffle_epi8(survival, count);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + x),
+                        _mm256_blendv_epi8(survives, born, dead));
+  }
+#elif defined(__SSE2__)
+  // SSE2 has no byte shuffle, so compare against each count the rule uses instead
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i one = _mm_set1_epi8(1);
+  __m128i birth_masks[9], survival_masks[9];
+  for (int k = 0; k <= 8; k++) {
+    birth_masks[k] = ((rule.birth >> k) & 1) ? _mm_set1_epi8(-1) : zero;
+    survival_masks[k] = ((rule.survival >> k) & 1) ? _mm_set1_epi8(-1) : zero;
+  }
+  for (; x + 16 <= x_end; x += 16) {
+    auto load = [](const cell_t *p) {
+      return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    };
+    __m128i count = _mm_add_epi8(load(up + x - 1), load(up + x));
+    count = _mm_add_epi8(count, load(up + x + 1));
+    count = _mm_add_epi8(count, load(mid + x - 1));
+    count = _mm_add_epi8(count, load(mid + x + 1));
+    count = _mm_add_epi8(count, load(down + x - 1));
+    count = _mm_add_epi8(count, load(down + x));
+    count = _mm_add_epi8(count, load(down + x + 1));
+    __m128i dead = _mm_cmpeq_epi8(load(mid + x), zero);
+    __m128i next = zero;
+    for (int k = 0; k <= 8; k++) {
+      __m128i allowed = _mm_or_si128(_mm_and_si128(dead, birth_masks[k]),
+                                     _mm_andnot_si128(dead, survival_masks[k]));
+      next = _mm_or_si128(next, _mm_and_si128(_mm_cmpeq_epi8(count, _mm_set1_epi8(k)), allowed));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + x), _mm_and_si128(next, one));
+  }
+#endif
+  // whatever is left over (or everything, without SIMD support)
+  update_span_scalar(up, mid, down, out, x, x_end, rule);
+}
+} // namespace
+
+/**
+ * @brief perform one iteration of the given rule on a halo-padded world
+ *
+ * @param read the current state of the world, with its halo already refreshed
+ * @param write the next state of the world. its halo is left stale.
+ * @param rule the rule to apply
+ */
+void update_halo_state(const HaloWorld &read, HaloWorld &write, Rule rule) {
+  update_halo_state(read, write, rule, 0, read.height, 0, read.width);
+}
+
+void update_halo_state(const HaloWorld &read, HaloWorld &write, Rule rule, int y_begin,
+                       int y_end, int x_begin, int x_end) {
+  if (x_begin >= x_end) return;
+  const size_t stride = read.stride;
+  // interior coordinates to padded ones
+  for (size_t y = y_begin + 1; y <= static_cast<size_t>(y_end); y++) {
+    update_row(&read.state[(y - 1) * stride], &read.state[y * stride],
+               &read.state[(y + 1) * stride], &write.state[y * stride], x_begin + 1, x_end + 1,
+               rule);
+  }
+}
+
+std::string halo_kernel_isa() {
+#if defined(__AVX512BW__)
+  return "avx512";
+#elif defined(__AVX2__)
+  return "avx2";
+#elif defined(__SSE2__)
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
+
+} // namespace ca
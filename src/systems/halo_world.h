@@ -0,0 +1,48 @@
+// Defines a halo-padded (ghost cell) representation of the cellular automata state, along with
+// a SIMD CPU update kernel that processes whole rows without per-neighbor modulo wrapping.
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "rule.h"
+#include "types.h"
+
+namespace ca {
+
+// World surrounded by a one cell wide ring of ghost cells. Before each generation, the ghost
+// cells are refreshed with copies of the opposite edges, so the toroidal wrap is done once per
+// generation instead of once per neighbor. Cell (x, y) lives at state[(y + 1) * stride + x + 1].
+struct HaloWorld {
+  pooled_vector<cell_t> state;
+  int width{0};
+  int height{0};
+  int stride{0};
+
+  HaloWorld() = default;
+  // copy a world into the interior of a halo-padded buffer
+  explicit HaloWorld(const World &world);
+
+  // copy the interior back out (used for validation against the other benchmarks)
+  World to_world() const;
+
+  // copy the opposite edges into the ghost rows, columns and corners
+  void refresh_halo();
+
+  unsigned long get_mem_size() const {
+    return state.size() * sizeof(cell_t) + 3 * sizeof(int);
+  }
+};
+
+// perform one iteration of the given rule. read must have a fresh halo.
+void update_halo_state(const HaloWorld &read, HaloWorld &write, Rule rule);
+
+// update only the cells in rows [y_begin, y_end) and columns [x_begin, x_end) (in interior
+// coordinates). only the ghost cells next to that rectangle need to be fresh.
+void update_halo_state(const HaloWorld &read, HaloWorld &write, Rule rule, int y_begin,
+                       int y_end, int x_begin, int x_end);
+
+// name of the instruction set the SIMD kernel was compiled for ("avx512", "avx2", "sse2" or "scalar")
+std::string halo_kernel_isa();
+
+} // namespace ca
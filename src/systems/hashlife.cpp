@@ -0,0 +1,417 @@
+// Defines a HashLife engine: a canonicalized (hash-consed) quadtree with memoized results,
+// which can advance structured patterns by very large numbers of generations.
+//
+// The toroidal world is embedded in the infinite plane by tiling it periodically. The infinite
+// tiling evolves exactly like the torus, so advancing a large enough square of the tiling and
+// reading one period back out gives the same result as the other engines.
+#include "hashlife.h"
+
+#include <algorithm>
+
+namespace ca {
+
+namespace {
+// 16 rows of 16 cells, used to simulate the base case directly
+using Rows16 = std::uint64_t[16];
+
+// unpack four 8x8 leaves into a 16x16 block
+void leaves_to_rows(word_t nw, word_t ne, word_t sw, word_t se, Rows16 rows) {
+  for (int y = 0; y < 8; y++) {
+    rows[y] = ((nw >> (8 * y)) & 0xff) | (((ne >> (8 * y)) & 0xff) << 8);
+    rows[y + 8] = ((sw >> (8 * y)) & 0xff) | (((se >> (8 * y)) & 0xff) << 8);
+  }
+}
+
+// pack the centered 8x8 of a 16x16 block into a leaf
+word_t rows_center_leaf(const Rows16 rows) {
+  word_t leaf = 0;
+  for (int y = 0; y < 8; y++) {
+    leaf |= ((rows[y + 4] >> 4) & 0xff) << (8 * y);
+  }
+  return leaf;
+}
+
+int ceil_log2(long x) {
+  int level = 0;
+  while ((1L << level) < x) {
+    level++;
+  }
+  return level;
+}
+
+long positive_mod(long x, long m) {
+  return ((x % m) + m) % m;
+}
+} // namespace
+
+HashLife::HashLife(const World &world, size_t memory_cap_bytes, Rule rule)
+    : state(world), memory_cap_bytes(memory_cap_bytes), rule(rule) {
+  rehash(1 << 16);
+}
+
+size_t HashLife::get_mem_size() const {
+  return nodes.capacity() * sizeof(Node) + table.capacity() * sizeof(node_id) +
+         state.get_mem_size();
+}
+
+std::uint64_t HashLife::hash_node(const Node &node) const {
+  std::uint64_t h;
+  if (node.level == LEAF_LEVEL) {
+    h = node.leaf;
+  } else {
+    h = node.nw;
+    h = h * 0x9e3779b97f4a7c15ULL + node.ne;
+    h = h * 0x9e3779b97f4a7c15ULL + node.sw;
+    h = h * 0x9e3779b97f4a7c15ULL + node.se;
+  }
+  // final mix (splitmix64 finalizer) so that nearby ids spread across the table
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+  return h;
+}
+
+void HashLife::rehash(size_t capacity) {
+  table.assign(capacity, NONE);
+  const size_t mask = capacity - 1;
+  for (node_id id = 0; id < nodes.size(); id++) {
+    size_t slot = hash_node(nodes[id]) & mask;
+    while (table[slot] != NONE) {
+      slot = (slot + 1) & mask;
+    }
+    table[slot] = id;
+  }
+}
+
+HashLife::node_id HashLife::intern(const Node &node) {
+  const size_t mask = table.size() - 1;
+  size_t slot = hash_node(node) & mask;
+  while (table[slot] != NONE) {
+    const Node &other = nodes[table[slot]];
+    if (other.level == node.level &&
+        (node.level == LEAF_LEVEL
+             ? other.leaf == node.leaf
+             : (other.nw == node.nw && other.ne == node.ne && other.sw == node.sw &&
+                other.se == node.se))) {
+      return table[slot];
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  // not found: add it. keep the table at most half full.
+  node_id id = static_cast<node_id>(nodes.size());
+  nodes.push_back(node);
+  table[slot] = id;
+  if (nodes.size() * 2 > table.size()) {
+    rehash(table.size() * 2);
+  }
+  peak_mem_size = std::max(peak_mem_size, get_mem_size());
+  return id;
+}
+
+HashLife::node_id HashLife::make_leaf(word_t bits) {
+  Node node;
+  node.level = LEAF_LEVEL;
+  node.leaf = bits;
+  return intern(node);
+}
+
+HashLife::node_id HashLife::join(node_id nw, node_id ne, node_id sw, node_id se) {
+  Node node;
+  node.level = static_cast<std::int8_t>(nodes[nw].level + 1);
+  node.nw = nw;
+  node.ne = ne;
+  node.sw = sw;
+  node.se = se;
+  return intern(node);
+}
+
+HashLife::node_id HashLife::empty(int level) {
+  if (static_cast<int>(empties.size()) <= level) {
+    empties.resize(level + 1, NONE);
+  }
+  if (empties[level] == NONE) {
+    if (level == LEAF_LEVEL) {
+      empties[level] = make_leaf(0);
+    } else {
+      node_id e = empty(level - 1);
+      empties[level] = join(e, e, e, e);
+    }
+  }
+  return empties[level];
+}
+
+HashLife::node_id HashLife::center(node_id n) {
+  // copy, since creating nodes may reallocate the node store
+  const Node node = nodes[n];
+  const Node nw = nodes[node.nw], ne = nodes[node.ne], sw = nodes[node.sw], se = nodes[node.se];
+  if (node.level == LEAF_LEVEL + 1) {
+    Rows16 rows;
+    leaves_to_rows(nw.leaf, ne.leaf, sw.leaf, se.leaf, rows);
+    return make_leaf(rows_center_leaf(rows));
+  }
+  return join(nw.se, ne.sw, sw.ne, se.nw);
+}
+
+HashLife::node_id HashLife::step_base(node_id n, int step) {
+  const Node node = nodes[n];
+  Rows16 rows, next;
+  leaves_to_rows(nodes[node.nw].leaf, nodes[node.ne].leaf, nodes[node.sw].leaf,
+                 nodes[node.se].leaf, rows);
+  // simulate the 16x16 block with dead cells outside. errors creep in one cell per
+  // generation from the edges, so the center 8x8 is exact for up to 4 generations.
+  with_rule_kernel(rule, [&](auto kernel) {
+    for (int gen = 0; gen < (1 << step); gen++) {
+      for (int y = 0; y < 16; y++) {
+        word_t up = y > 0 ? rows[y - 1] : 0;
+        word_t mid = rows[y];
+        word_t down = y < 15 ? rows[y + 1] : 0;
+        next[y] = kernel(up << 1, up, up >> 1, mid << 1, mid, mid >> 1, down << 1, down,
+                         down >> 1) &
+                  0xffff;
+      }
+      std::copy(next, next + 16, rows);
+    }
+  });
+  return make_leaf(rows_center_leaf(rows));
+}
+
+HashLife::node_id HashLife::step(node_id n, int step) {
+  const Node node = nodes[n];
+  if (node.result != NONE && node.result_step == step) {
+    return node.result;
+  }
+  const int level = node.level;
+  // empty space stays empty, unless the rule gives birth with 0 neighbors
+  if (!(rule.birth & 1) && n == empty(level)) {
+    return empty(level - 1);
+  }
+
+  node_id result;
+  if (level == LEAF_LEVEL + 1) {
+    result = step_base(n, step);
+  } else {
+    const Node a = nodes[node.nw], b = nodes[node.ne], c = nodes[node.sw], d = nodes[node.se];
+    // the nine overlapping level - 1 subsquares
+    node_id n00 = node.nw;
+    node_id n01 = join(a.ne, b.nw, a.se, b.sw);
+    node_id n02 = node.ne;
+    node_id n10 = join(a.sw, a.se, c.nw, c.ne);
+    node_id n11 = join(a.se, b.sw, c.ne, d.nw);
+    node_id n12 = join(b.sw, b.se, d.nw, d.ne);
+    node_id n20 = node.sw;
+    node_id n21 = join(c.ne, d.nw, c.se, d.sw);
+    node_id n22 = node.se;
+
+    node_id r00, r01, r02, r10, r11, r12, r20, r21, r22;
+    int inner_step;
+    if (step == level - 2) {
+      // full speed: advance by half the generations in each of two rounds
+      r00 = this->step(n00, step - 1);
+      r01 = this->step(n01, step - 1);
+      r02 = this->step(n02, step - 1);
+      r10 = this->step(n10, step - 1);
+      r11 = this->step(n11, step - 1);
+      r12 = this->step(n12, step - 1);
+      r20 = this->step(n20, step - 1);
+      r21 = this->step(n21, step - 1);
+      r22 = this->step(n22, step - 1);
+      inner_step = step - 1;
+    } else {
+      // slower than full speed: no time passes in the first round
+      r00 = center(n00);
+      r01 = center(n01);
+      r02 = center(n02);
+      r10 = center(n10);
+      r11 = center(n11);
+      r12 = center(n12);
+      r20 = center(n20);
+      r21 = center(n21);
+      r22 = center(n22);
+      inner_step = step;
+    }
+    node_id s00 = this->step(join(r00, r01, r10, r11), inner_step);
+    node_id s01 = this->step(join(r01, r02, r11, r12), inner_step);
+    node_id s10 = this->step(join(r10, r11, r20, r21), inner_step);
+    node_id s11 = this->step(join(r11, r12, r21, r22), inner_step);
+    result = join(s00, s01, s10, s11);
+  }
+
+  nodes[n].result = result;
+  nodes[n].result_step = static_cast<std::int8_t>(step);
+  return result;
+}
+
+HashLife::node_id HashLife::build(long x, long y, int level) {
+  x = positive_mod(x, state.width);
+  y = positive_mod(y, state.height);
+  const std::uint64_t key =
+      ((static_cast<std::uint64_t>(x) * state.height + y) << 6) | static_cast<std::uint64_t>(level);
+  auto it = build_cache.find(key);
+  if (it != build_cache.end()) {
+    return it->second;
+  }
+
+  node_id n;
+  if (level == LEAF_LEVEL) {
+    word_t bits = 0;
+    for (int r = 0; r < 8; r++) {
+      bits |= (state.load_word(x, y + r) & 0xff) << (8 * r);
+    }
+    n = make_leaf(bits);
+  } else {
+    const long half = 1L << (level - 1);
+    node_id nw = build(x, y, level - 1);
+    node_id ne = build(x + half, y, level - 1);
+    node_id sw = build(x, y + half, level - 1);
+    node_id se = build(x + half, y + half, level - 1);
+    n = join(nw, ne, sw, se);
+  }
+  build_cache.emplace(key, n);
+  return n;
+}
+
+void HashLife::export_node(node_id n, long x, long y, long ox, long oy, BitWorld &out) const {
+  const Node &node = nodes[n];
+  const long size = 1L << node.level;
+  // skip anything outside the window, and anything empty (the output starts out dead)
+  if (x + size <= ox || y + size <= oy || x >= ox + out.width || y >= oy + out.height) {
+    return;
+  }
+  if (node.level < static_cast<int>(empties.size()) && empties[node.level] == n) {
+    return;
+  }
+
+  if (node.level == LEAF_LEVEL) {
+    for (int r = 0; r < 8; r++) {
+      for (int c = 0; c < 8; c++) {
+        long tx = x + c - ox;
+        long ty = y + r - oy;
+        if (((node.leaf >> (8 * r + c)) & 1) && tx >= 0 && tx < out.width && ty >= 0 &&
+            ty < out.height) {
+          out.words[ty * out.words_per_row + tx / CELLS_PER_WORD] |= word_t{1}
+                                                                    << (tx % CELLS_PER_WORD);
+        }
+      }
+    }
+    return;
+  }
+  const long half = size / 2;
+  export_node(node.nw, x, y, ox, oy, out);
+  export_node(node.ne, x + half, y, ox, oy, out);
+  export_node(node.sw, x, y + half, ox, oy, out);
+  export_node(node.se, x + half, y + half, ox, oy, out);
+}
+
+void HashLife::advance_pow2(int step) {
+  // the root must be large enough that (a) step <= level - 2, and (b) its center result,
+  // which is half as wide, still contains one whole period of the tiling at any offset.
+  const int world_level = ceil_log2(std::max(state.width, state.height));
+  const int level = std::max({world_level, step, LEAF_LEVEL - 1}) + 2;
+
+  build_cache.clear();
+  node_id root = build(0, 0, level);
+  build_cache.clear();
+  maybe_collect_garbage(root);
+
+  node_id result = this->step(root, step);
+  empty(level);  // make sure every empty level is known, so export can skip empty space
+
+  // the result covers the tiling starting at (2^(level-2), 2^(level-2)). read back one
+  // period, starting at the first offset that lines up with the torus origin.
+  const long shift = 1L << (level - 2);
+  const long ox = positive_mod(-shift, state.width);
+  const long oy = positive_mod(-shift, state.height);
+  BitWorld next(state.width, state.height);
+  export_node(result, 0, 0, ox, oy, next);
+  state = std::move(next);
+
+  maybe_collect_garbage(result);
+}
+
+void HashLife::advance(long generations) {
+  for (int bit = 62; bit >= 0; bit--) {
+    if ((generations >> bit) & 1) {
+      advance_pow2(bit);
+    }
+  }
+}
+
+World HashLife::to_world() const {
+  return state.to_world();
+}
+
+void HashLife::maybe_collect_garbage(node_id &root) {
+  if (get_mem_size() <= memory_cap_bytes) {
+    return;
+  }
+  std::vector<node_id> roots{root};
+  collect_garbage(roots, true);
+  if (get_mem_size() > memory_cap_bytes / 2) {
+    // keeping the memoized results is not enough; drop them too
+    collect_garbage(roots, false);
+  }
+  root = roots[0];
+}
+
+void HashLife::collect_garbage(std::vector<node_id> &roots, bool keep_results) {
+  // mark everything reachable from the roots
+  std::vector<node_id> stack(roots.begin(), roots.end());
+  while (!stack.empty()) {
+    node_id n = stack.back();
+    stack.pop_back();
+    Node &node = nodes[n];
+    if (node.marked) {
+      continue;
+    }
+    node.marked = true;
+    if (node.level > LEAF_LEVEL) {
+      stack.insert(stack.end(), {node.nw, node.ne, node.sw, node.se});
+    }
+    if (keep_results && node.result != NONE) {
+      stack.push_back(node.result);
+    }
+  }
+
+  // compact the survivors, keeping their relative order (children always precede parents)
+  std::vector<node_id> remap(nodes.size(), NONE);
+  std::vector<Node> survivors;
+  for (node_id id = 0; id < nodes.size(); id++) {
+    if (nodes[id].marked) {
+      remap[id] = static_cast<node_id>(survivors.size());
+      survivors.push_back(nodes[id]);
+    }
+  }
+  for (Node &node : survivors) {
+    node.marked = false;
+    if (node.level > LEAF_LEVEL) {
+      node.nw = remap[node.nw];
+      node.ne = remap[node.ne];
+      node.sw = remap[node.sw];
+      node.se = remap[node.se];
+    }
+    if (node.result != NONE) {
+      node.result = keep_results ? remap[node.result] : NONE;
+      if (node.result == NONE) {
+        node.result_step = -1;
+      }
+    }
+  }
+  for (node_id &root : roots) {
+    root = remap[root];
+  }
+
+  nodes = std::move(survivors);
+  size_t capacity = 1 << 16;
+  while (capacity < nodes.size() * 2) {
+    capacity *= 2;
+  }
+  rehash(capacity);
+  empties.clear();
+  build_cache.clear();
+  gc_count++;
+}
+
+} // namespace ca
@@ -0,0 +1,105 @@
+// Defines a HashLife engine: a canonicalized (hash-consed) quadtree with memoized results,
+// which can advance structured patterns by very large numbers of generations.
+//
+// The toroidal world is embedded in the infinite plane by tiling it periodically. The infinite
+// tiling evolves exactly like the torus, so advancing a large enough square of the tiling and
+// reading one period back out gives the same result as the other engines.
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "bit_world.h"
+#include "rule.h"
+#include "types.h"
+
+namespace ca {
+
+// default memory cap for the node store, in megabytes
+constexpr int HASHLIFE_MEMORY_MB = 1024;
+
+class HashLife {
+public:
+  /**
+   * @brief import a world into the engine
+   *
+   * @param world the initial state
+   * @param memory_cap_bytes soft cap on the memory used by the node store. when it is exceeded,
+   * unreachable nodes (and, if needed, memoized results) are garbage collected.
+   * @param rule the rule to apply
+   */
+  HashLife(const World &world, size_t memory_cap_bytes, Rule rule);
+
+  // advance the world by the given number of generations
+  void advance(long generations);
+
+  // export the current state
+  World to_world() const;
+
+  // memory currently used by the node store and its hash table
+  size_t get_mem_size() const;
+  // largest value get_mem_size() reached
+  size_t get_peak_mem_size() const { return peak_mem_size; }
+  // number of garbage collections performed so far
+  int get_gc_count() const { return gc_count; }
+
+private:
+  using node_id = std::uint32_t;
+  static constexpr node_id NONE = 0xffffffff;
+  // leaves are 8x8 blocks of cells, stored as one word (bit y * 8 + x is cell (x, y))
+  static constexpr int LEAF_LEVEL = 3;
+
+  struct Node {
+    node_id nw{NONE}, ne{NONE}, sw{NONE}, se{NONE};
+    word_t leaf{0};
+    // memoized result of step(this, result_step), or NONE
+    node_id result{NONE};
+    std::int8_t level{0};
+    std::int8_t result_step{-1};
+    bool marked{false};
+  };
+
+  // hash-consing constructors. return the canonical node with the given contents.
+  node_id make_leaf(word_t bits);
+  node_id join(node_id nw, node_id ne, node_id sw, node_id se);
+  node_id empty(int level);
+
+  // the level-(L-1) node centered in a level-L node (no time passes)
+  node_id center(node_id n);
+  // the level-(L-1) node centered in a level-L node, 2^step generations later (step <= L - 2)
+  node_id step(node_id n, int step);
+  // base case of step for level LEAF_LEVEL + 1 nodes, by direct simulation
+  node_id step_base(node_id n, int step);
+
+  // build the node covering the square of side 2^level at (x, y) in the periodic tiling of state
+  node_id build(long x, long y, int level);
+  // advance the stored state by exactly 2^step generations
+  void advance_pow2(int step);
+  // write the window of node n (at (x, y) in some frame) that overlaps the torus at (ox, oy)
+  void export_node(node_id n, long x, long y, long ox, long oy, BitWorld &out) const;
+
+  // hash table lookup helpers
+  std::uint64_t hash_node(const Node &node) const;
+  node_id intern(const Node &node);
+  void rehash(size_t capacity);
+
+  // mark-compact garbage collection, keeping the given roots. if keep_results is true,
+  // memoized results of surviving nodes (and everything they reference) are kept too.
+  void collect_garbage(std::vector<node_id> &roots, bool keep_results);
+  void maybe_collect_garbage(node_id &root);
+
+  std::vector<Node> nodes;
+  std::vector<node_id> table;  // open addressing hash table of node ids
+  std::vector<node_id> empties;
+  std::unordered_map<std::uint64_t, node_id> build_cache;
+
+  // current state, kept flat between power-of-two steps
+  BitWorld state;
+  size_t memory_cap_bytes;
+  Rule rule;
+  size_t peak_mem_size{0};
+  int gc_count{0};
+};
+
+} // namespace ca
@@ -0,0 +1,177 @@
+// Defines a toroidal engine for sparse worlds that keeps a sorted list of the living cells rather
+// than a grid. Each generation, the neighbors of every living cell are radix sorted, so the
+// neighbor counts come out as runs of equal cells, and the runs are merged with the living cells
+// to apply the rule. Above a density threshold it switches to the bit-packed grid, and back below.
+#include "live_cells.h"
+
+#include <bit>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace ca {
+
+namespace {
+constexpr int RADIX_BUCKETS = 1 << LIVE_CELL_RADIX_BITS;
+constexpr std::uint32_t NO_CELL = std::numeric_limits<std::uint32_t>::max();
+
+// sort keys that are below 2^bits, least significant digit first. every pass moves the keys
+// between keys and scratch, and the sorted keys end up in keys.
+void radix_sort(pooled_vector<std::uint32_t> &keys, pooled_vector<std::uint32_t> &scratch,
+                int bits) {
+  scratch.resize(keys.size());
+  for (int shift = 0; shift < bits; shift += LIVE_CELL_RADIX_BITS) {
+    size_t offsets[RADIX_BUCKETS] = {};
+    for (std::uint32_t key : keys) {
+      offsets[(key >> shift) & (RADIX_BUCKETS - 1)]++;
+    }
+    size_t total = 0;
+    for (size_t &offset : offsets) {
+      const size_t count = offset;
+      offset = total;
+      total += count;
+    }
+    for (std::uint32_t key : keys) {
+      scratch[offsets[(key >> shift) & (RADIX_BUCKETS - 1)]++] = key;
+    }
+    std::swap(keys, scratch);
+  }
+}
+} // namespace
+
+LiveCellWorld::LiveCellWorld(const World &world, Rule rule, double dense_density)
+    : width(world.width), height(world.height), rule(rule), dense_density(dense_density) {
+  if (static_cast<std::uint64_t>(width) * height >= NO_CELL) {
+    throw std::invalid_argument("world too large for a live cell list");
+  }
+  for (size_t i = 0; i < world.state.size(); ++i) {
+    if (world.state[i]) live.push_back(static_cast<std::uint32_t>(i));
+  }
+  const double cells = static_cast<double>(width) * height;
+  if ((rule.birth & 1) || live.size() > dense_density * cells) {
+    to_dense();
+    mode_switches = 0;
+  }
+}
+
+void LiveCellWorld::step() {
+  const double cells = static_cast<double>(width) * height;
+  if (dense) {
+    step_dense();
+    // with B0, empty neighborhoods come to life, so the list cannot represent the next step
+    if (!(rule.birth & 1) && dense_population < dense_density * LIVE_CELL_HYSTERESIS * cells) {
+      to_sparse();
+    }
+  } else {
+    step_sparse();
+    if (live.size() > dense_density * cells) to_dense();
+  }
+}
+
+void LiveCellWorld::step_sparse() {
+  // the eight neighbors of every living cell, wrapping around the world
+  keys.resize(live.size() * 8);
+  std::uint32_t *out = keys.data();
+  // the dimensions as unsigned, like the cell indices they are compared with
+  const std::uint32_t w = width;
+  const std::uint32_t h = height;
+  for (std::uint32_t cell : live) {
+    const std::uint32_t y = cell / w;
+    const std::uint32_t x = cell - y * w;
+    const std::uint32_t west = x == 0 ? w - 1 : x - 1;
+    const std::uint32_t east = x + 1 == w ? 0 : x + 1;
+    const std::uint32_t north = (y == 0 ? h - 1 : y - 1) * w;
+    const std::uint32_t row = y * w;
+    const std::uint32_t south = (y + 1 == h ? 0 : y + 1) * w;
+    out[0] = north + west;
+    out[1] = north + x;
+    out[2] = north + east;
+    out[3] = row + west;
+    out[4] = row + east;
+    out[5] = south + west;
+    out[6] = south + x;
+    out[7] = south + east;
+    out += 8;
+  }
+
+  // once sorted, the number of times a cell appears is its neighbor count
+  const std::uint64_t cells = static_cast<std::uint64_t>(width) * height;
+  radix_sort(keys, scratch, std::bit_width(cells - 1));
+
+  // merge the runs of equal neighbors with the living cells, both in ascending order, so the
+  // next list comes out sorted too
+  next.clear();
+  const size_t num_keys = keys.size();
+  const size_t num_live = live.size();
+  size_t k = 0;
+  size_t l = 0;
+  while (k < num_keys || l < num_live) {
+    const std::uint32_t neighbor = k < num_keys ? keys[k] : NO_CELL;
+    const std::uint32_t living = l < num_live ? live[l] : NO_CELL;
+    if (living < neighbor) {
+      // a living cell without living neighbors
+      if (rule.survival & 1) next.push_back(living);
+      ++l;
+      continue;
+    }
+    size_t end = k + 1;
+    while (end < num_keys && keys[end] == neighbor) ++end;
+    const bool alive = living == neighbor;
+    if (alive) ++l;
+    if (rule.next(alive, static_cast<int>(end - k))) next.push_back(neighbor);
+    k = end;
+  }
+  std::swap(live, next);
+  ++sparse_steps;
+}
+
+void LiveCellWorld::step_dense() {
+  dense_population = update_bit_state_counted(read, write, rule).population;
+  std::swap(read.words, write.words);
+  ++dense_steps;
+}
+
+void LiveCellWorld::to_dense() {
+  read = BitWorld(width, height);
+  write = BitWorld(width, height);
+  for (std::uint32_t cell : live) {
+    const std::uint32_t y = cell / width;
+    const std::uint32_t x = cell - y * width;
+    read.words[static_cast<size_t>(y) * read.words_per_row + x / CELLS_PER_WORD] |=
+        word_t{1} << (x % CELLS_PER_WORD);
+  }
+  dense_population = live.size();
+  live.clear();
+  dense = true;
+  ++mode_switches;
+}
+
+void LiveCellWorld::to_sparse() {
+  live.clear();
+  for (int y = 0; y < height; ++y) {
+    const word_t *row = &read.words[static_cast<size_t>(y) * read.words_per_row];
+    for (int w = 0; w < read.words_per_row; ++w) {
+      // visit the set bits only
+      for (word_t bits = row[w]; bits != 0; bits &= bits - 1) {
+        const int x = w * CELLS_PER_WORD + std::countr_zero(bits);
+        live.push_back(static_cast<std::uint32_t>(y) * width + x);
+      }
+    }
+  }
+  // the grid is no longer needed
+  read = BitWorld();
+  write = BitWorld();
+  dense = false;
+  ++mode_switches;
+}
+
+World LiveCellWorld::to_world() const {
+  if (dense) return read.to_world();
+  World world(width, height);
+  for (std::uint32_t cell : live) {
+    world.state[cell] = 1;
+  }
+  return world;
+}
+
+} // namespace ca
@@ -0,0 +1,75 @@
+// Defines a toroidal engine for sparse worlds that keeps a sorted list of the living cells rather
+// than a grid. Each generation, the neighbors of every living cell are radix sorted, so the
+// neighbor counts come out as runs of equal cells, and the runs are merged with the living cells
+// to apply the rule. Above a density threshold it switches to the bit-packed grid, and back below.
+#pragma once
+
+#include <cstdint>
+
+#include "bit_world.h"
+#include "buffer_pool.h"
+#include "rule.h"
+#include "types.h"
+
+namespace ca {
+
+// fraction of living cells above which the grid is faster than the list
+constexpr double LIVE_CELL_DENSITY = 0.003;
+// the grid switches back to the list below the density threshold times this, so a world hovering
+// around the threshold does not convert back and forth every generation
+constexpr double LIVE_CELL_HYSTERESIS = 0.5;
+// bits of a cell index sorted per radix pass
+constexpr int LIVE_CELL_RADIX_BITS = 11;
+
+class LiveCellWorld {
+public:
+  /**
+   * @brief import a world, as a list if it is sparse enough and as a grid otherwise
+   *
+   * @param world the initial state. it must have fewer than 2^32 cells.
+   * @param rule the rule to apply. rules with B0 always use the grid, since they bring every
+   * cell without living neighbors to life.
+   * @param dense_density fraction of living cells above which the grid is used
+   */
+  LiveCellWorld(const World &world, Rule rule, double dense_density = LIVE_CELL_DENSITY);
+
+  // advance one generation, then switch representation if the density crossed the threshold
+  void step();
+
+  World to_world() const;
+
+  bool is_dense() const { return dense; }
+  std::uint64_t population() const { return dense ? dense_population : live.size(); }
+  // generations advanced on the list and on the grid so far, and conversions between the two
+  long sparse_generations() const { return sparse_steps; }
+  long dense_generations() const { return dense_steps; }
+  int switches() const { return mode_switches; }
+
+private:
+  void step_sparse();
+  void step_dense();
+  void to_dense();
+  void to_sparse();
+
+  int width;
+  int height;
+  Rule rule;
+  double dense_density;
+  bool dense{false};
+  // living cells as indices y * width + x, in ascending order (while !dense)
+  pooled_vector<std::uint32_t> live;
+  // neighbors of the living cells, and the buffers the sort and merge write into. kept between
+  // generations so they are only allocated while the population grows.
+  pooled_vector<std::uint32_t> keys;
+  pooled_vector<std::uint32_t> scratch;
+  pooled_vector<std::uint32_t> next;
+  // the grid (while dense)
+  BitWorld read;
+  BitWorld write;
+  std::uint64_t dense_population{0};
+  long sparse_steps{0};
+  long dense_steps{0};
+  int mode_switches{0};
+};
+
+} // namespace ca
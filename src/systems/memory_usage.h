@@ -0,0 +1,22 @@
+// Defines measurement of the process's resident memory, so benchmarks report the memory a job
+// actually touched rather than an estimate from the sizes of its data structures.
+#pragma once
+
+namespace ca {
+
+/**
+ * @brief restart the peak resident set size at the current resident set size
+ *
+ * writes to /proc/self/clear_refs (Linux 4.0 and later).
+ * @return false if the peak could not be reset, so it still covers the whole process lifetime
+ */
+bool reset_peak_rss();
+
+// peak resident set size in bytes (VmHWM) since the process started or the last reset, 0 if
+// unavailable
+unsigned long peak_rss();
+
+// current resident set size in bytes (VmRSS), 0 if unavailable
+unsigned long current_rss();
+
+} // namespace ca
@@ -0,0 +1,96 @@
+// Defines optional hardware performance counter capture (cycles, instructions, LLC misses,
+// branch misses) through Linux perf_event_open, so that differences between engines can be
+// attributed to cache behavior, branch mispredicts or instruction counts.
+#include "perf_counters.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace ca {
+
+namespace {
+// the events, in the order of PerfCounters::fds. PERF_COUNT_HW_CACHE_MISSES is the generic
+// "cache misses" event, which the kernel maps to last level cache misses on common CPUs.
+constexpr std::uint64_t EVENTS[] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+int open_counter(std::uint64_t event) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = event;
+  attr.disabled = 1;
+  // count threads created while the counter is open (e.g. by std::thread inside a run)
+  attr.inherit = 1;
+  // user space only, which is allowed with the default perf_event_paranoid setting
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  // to scale the count if the kernel had to multiplex the counters
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+} // namespace
+
+PerfCounters::PerfCounters() {
+  for (int i = 0; i < NUM_COUNTERS; i++) {
+    fds[i] = open_counter(EVENTS[i]);
+    if (fds[i] < 0 && reason.empty()) {
+      reason = std::string("perf_event_open: ") + std::strerror(errno);
+    }
+  }
+  if (available()) {
+    reason.clear();
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  for (int fd : fds) {
+    if (fd >= 0) close(fd);
+  }
+}
+
+bool PerfCounters::available() const {
+  for (int fd : fds) {
+    if (fd >= 0) return true;
+  }
+  return false;
+}
+
+void PerfCounters::start() {
+  for (int fd : fds) {
+    if (fd < 0) continue;
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+void PerfCounters::stop(PerfCounts &counts) {
+  std::int64_t *targets[NUM_COUNTERS] = {&counts.cycles, &counts.instructions, &counts.llc_misses,
+                                         &counts.branch_misses};
+  for (int i = 0; i < NUM_COUNTERS; i++) {
+    if (fds[i] < 0) continue;
+    ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    // value, time enabled, time running
+    std::uint64_t data[3] = {0, 0, 0};
+    if (read(fds[i], data, sizeof(data)) != sizeof(data)) continue;
+    double value = static_cast<double>(data[0]);
+    if (data[2] > 0 && data[2] < data[1]) {
+      value *= static_cast<double>(data[1]) / data[2];
+    }
+    *targets[i] = std::max<std::int64_t>(*targets[i], 0) + static_cast<std::int64_t>(value);
+  }
+}
+
+PerfCounters &perf_counters() {
+  static PerfCounters counters;
+  return counters;
+}
+
+} // namespace ca
@@ -0,0 +1,99 @@
+// Defines optional hardware performance counter capture (cycles, instructions, LLC misses,
+// branch misses) through Linux perf_event_open, so that differences between engines can be
+// attributed to cache behavior, branch mispredicts or instruction counts.
+#pragma once
+
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace ca {
+
+// assumed cache line size, used to turn LLC misses into bytes of memory traffic
+constexpr int CACHE_LINE_BYTES = 64;
+
+// counter values for one job (averaged over its timed repetitions). a value of -1 means the
+// counter could not be opened on this machine.
+struct PerfCounts {
+  // were counters requested at all? if not, nothing is written to the JSON.
+  bool enabled{false};
+  std::int64_t cycles{-1};
+  std::int64_t instructions{-1};
+  std::int64_t llc_misses{-1};
+  std::int64_t branch_misses{-1};
+  // cells * generations computed by the job, for the per-cell metrics
+  double cell_updates{0};
+  // why no counters are available (empty if at least one is)
+  std::string unavailable_reason{};
+
+  bool available() const {
+    return cycles >= 0 || instructions >= 0 || llc_misses >= 0 || branch_misses >= 0;
+  }
+
+  std::string to_json() const {
+    std::stringstream ss;
+    ss << "{";
+    ss << "\"available\": " << (available() ? "true" : "false");
+    if (!available()) {
+      ss << ",\"reason\": \"" << unavailable_reason << "\"}";
+      return ss.str();
+    }
+    auto field = [&](const char *name, std::int64_t value) {
+      if (value >= 0) ss << ",\"" << name << "\": " << value;
+    };
+    field("cycles", cycles);
+    field("instructions", instructions);
+    field("llc_misses", llc_misses);
+    field("branch_misses", branch_misses);
+    // derived metrics
+    ss << std::defaultfloat << std::setprecision(6);
+    if (cycles > 0 && instructions >= 0) {
+      ss << ",\"ipc\": " << static_cast<double>(instructions) / cycles;
+    }
+    if (cell_updates > 0) {
+      if (llc_misses >= 0) {
+        ss << ",\"llc_misses_per_cell\": " << llc_misses / cell_updates;
+        ss << ",\"bytes_per_cell\": " << llc_misses * CACHE_LINE_BYTES / cell_updates;
+      }
+      if (branch_misses >= 0) {
+        ss << ",\"branch_misses_per_cell\": " << branch_misses / cell_updates;
+      }
+    }
+    ss << "}";
+    return ss.str();
+  }
+};
+
+// A set of counters for the thread that opens them, and any threads it creates afterwards
+// (counts of running threads are summed when the counters are read). Threads that already
+// existed when the counters were opened are not counted. Each counter is opened separately,
+// so any subset that the kernel and hardware support works.
+class PerfCounters {
+public:
+  PerfCounters();
+  ~PerfCounters();
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  // is at least one counter open?
+  bool available() const;
+  // why the counters could not be opened (empty if at least one was)
+  const std::string &unavailable_reason() const { return reason; }
+
+  // reset and start counting
+  void start();
+  // stop counting, and add the counts since start() to counts (unavailable counters stay -1)
+  void stop(PerfCounts &counts);
+
+private:
+  static constexpr int NUM_COUNTERS = 4;
+  int fds[NUM_COUNTERS];
+  std::string reason;
+};
+
+// the process-wide counters, opened on first use. call this before creating worker threads
+// (e.g. before constructing the benchmarks) so that the workers are counted too.
+PerfCounters &perf_counters();
+
+} // namespace ca
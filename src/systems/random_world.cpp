@@ -0,0 +1,84 @@
+// Defines a fast, deterministic generator for random initial states. It uses a counter-based RNG
+// (splitmix64 of a per-word counter), so the rows can be filled by any number of threads in any
+// order and still produce the same world for the same seed.
+#include "random_world.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace ca {
+
+namespace {
+constexpr std::uint64_t GOLDEN_GAMMA = 0x9e3779b97f4a7c15ULL;
+
+std::uint64_t mix(std::uint64_t key) {
+  // splitmix64 finalizer
+  key ^= key >> 30;
+  key *= 0xbf58476d1ce4e5b9ULL;
+  key ^= key >> 27;
+  key *= 0x94d049bb133111ebULL;
+  return key ^ (key >> 31);
+}
+
+// 64 cells, each alive with probability threshold / 2^DENSITY_BITS. the bits of the threshold are
+// applied from the least significant one up: a 1 bit ORs in a fresh random word, a 0 bit ANDs one
+// in, which takes a cell's probability p to (1 + p) / 2 or p / 2 respectively. trailing zero bits
+// would only AND into an all-zero word, so they are skipped.
+std::uint64_t random_word(std::uint64_t key, std::uint64_t counter, std::uint32_t threshold) {
+  if (threshold == 0) return 0;
+  if (threshold >> DENSITY_BITS) return ~std::uint64_t{0};
+  std::uint64_t state = key + counter * DENSITY_BITS * GOLDEN_GAMMA;
+  std::uint64_t word = 0;
+  for (int bit = __builtin_ctz(threshold); bit < DENSITY_BITS; bit++) {
+    state += GOLDEN_GAMMA;
+    const std::uint64_t r = mix(state);
+    word = (threshold >> bit) & 1 ? word | r : word & r;
+  }
+  return word;
+}
+} // namespace
+
+World random_world(int width, int height, double density, std::uint64_t seed,
+                   std::uint64_t stream, ThreadPool *pool) {
+  if (!(density >= 0 && density <= 1)) {
+    throw std::invalid_argument("density must be between 0 and 1, got " + std::to_string(density));
+  }
+  const std::uint32_t threshold =
+      static_cast<std::uint32_t>(std::lround(density * (1 << DENSITY_BITS)));
+  const std::uint64_t key = mix(seed) ^ mix(stream + GOLDEN_GAMMA);
+  const int words_per_row = (width + 63) / 64;
+
+  World world;
+  world.width = width;
+  world.height = height;
+  world.state.resize(static_cast<size_t>(width) * height);
+
+  auto fill_rows = [&](int y_begin, int y_end) {
+    for (int y = y_begin; y < y_end; y++) {
+      cell_t *row = &world.state[static_cast<size_t>(y) * width];
+      for (int w = 0; w < words_per_row; w++) {
+        const std::uint64_t counter = static_cast<std::uint64_t>(y) * words_per_row + w;
+        const std::uint64_t bits = random_word(key, counter, threshold);
+        const int x_end = std::min(width, 64 * (w + 1));
+        for (int x = 64 * w; x < x_end; x++) {
+          row[x] = (bits >> (x - 64 * w)) & 1;
+        }
+      }
+    }
+  };
+
+  if (pool == nullptr || pool->size() <= 1) {
+    fill_rows(0, height);
+  } else {
+    const int num_threads = pool->size();
+    pool->run([&](int thread_index) {
+      fill_rows(static_cast<int>(static_cast<long>(height) * thread_index / num_threads),
+                static_cast<int>(static_cast<long>(height) * (thread_index + 1) / num_threads));
+    });
+  }
+  return world;
+}
+
+} // namespace ca
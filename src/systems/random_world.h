@@ -0,0 +1,31 @@
+// Defines a fast, deterministic generator for random initial states. It uses a counter-based RNG
+// (splitmix64 of a per-word counter), so the rows can be filled by any number of threads in any
+// order and still produce the same world for the same seed.
+#pragma once
+
+#include <cstdint>
+
+#include "thread_pool.h"
+#include "types.h"
+
+namespace ca {
+
+// default fraction of living cells
+constexpr double DENSITY = 0.5;
+// the density is rounded to a multiple of 2^-DENSITY_BITS
+constexpr int DENSITY_BITS = 16;
+
+/**
+ * @brief generate a random world
+ *
+ * @param width world width
+ * @param height world height
+ * @param density probability of each cell being alive, from 0 to 1 (rounded to 2^-DENSITY_BITS)
+ * @param seed the seed. the same seed, stream and size always produce the same world.
+ * @param stream selects an independent sequence for the same seed (e.g. the job index)
+ * @param pool if given, the rows are split into bands across its threads
+ */
+World random_world(int width, int height, double density, std::uint64_t seed,
+                   std::uint64_t stream = 0, ThreadPool *pool = nullptr);
+
+} // namespace ca
@@ -1,42 +1,55 @@
-// render_state.cpp: Defines a helper function for rendering the state of the cellular automaton using SDL2.
+// render_state.cpp: Defines helpers for rendering the state of the cellular automaton using SDL2.
+// Worlds are drawn into a framebuffer in software (see framebuffer.h) and uploaded through one
+// streaming texture, so the cost does not grow with the number of living cells.
 #include "render_state.h"
 
 #include <SDL.h>
-#include <algorithm>
+
+#include <stdexcept>
+#include <string>
 
 namespace ca {
-/**
- * @brief draws the current state of the cellular automaton to the screen
- *
- * @param state array of cells representing CA state
- * @param width width of the CA state
- * @param height height of the CA state
- * @param renderer SDL renderer to draw to
- * @param window SDL window to draw to
- */
-void render_state(World &world, SDL_Renderer *renderer, SDL_Window *window) {
-  // clear the screen
-  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-  SDL_RenderClear(renderer);
-
-  // set the draw color to white
-  SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-
-  // calculate the size of each cell
-  int screen_width, screen_height;
-  SDL_GetWindowSize(window, &screen_width, &screen_height);
-  int cell_size = std::min(screen_width / world.width, screen_height / world.height);
-
-  // draw each cell
-  for (int y = 0; y < world.height; y++) {
-    for (int x = 0; x < world.width; x++) {
-      // only draw cells that are alive
-      if (world.state[y * world.width + x] != 0) {
-        SDL_Rect rect = {x * cell_size, y * cell_size, cell_size, cell_size};
-        SDL_RenderFillRect(renderer, &rect);
-      }
-    }
+
+StreamingRenderer::StreamingRenderer(SDL_Renderer *renderer, ThreadPool *pool)
+    : renderer(renderer), pool(pool) {
+  resize();
+}
+
+StreamingRenderer::~StreamingRenderer() {
+  if (texture != nullptr) SDL_DestroyTexture(texture);
+}
+
+void StreamingRenderer::resize() {
+  int width = 0, height = 0;
+  SDL_GetRendererOutputSize(renderer, &width, &height);
+  if (texture != nullptr && width == frame.width && height == frame.height) return;
+  if (texture != nullptr) SDL_DestroyTexture(texture);
+  // RGBA32 is the byte order R, G, B, A on every platform, matching pixel_t
+  texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING,
+                              width, height);
+  if (texture == nullptr) {
+    throw std::runtime_error(std::string("failed to create texture: ") + SDL_GetError());
   }
+  frame = Framebuffer(width, height);
+}
+
+void StreamingRenderer::present() {
+  // a single upload and copy per frame
+  SDL_UpdateTexture(texture, nullptr, frame.pixels.data(),
+                    frame.width * static_cast<int>(sizeof(pixel_t)));
+  SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+}
+
+void StreamingRenderer::draw(const World &world, const Viewport &view) {
+  resize();
+  render_frame(world, view, frame, pool);
+  present();
+}
+
+void StreamingRenderer::draw(const BitWorld &world, const Viewport &view) {
+  resize();
+  render_frame(world, view, frame, pool);
+  present();
 }
 
 } // namespace ca
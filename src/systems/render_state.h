@@ -1,12 +1,42 @@
-// render_state.h: Defines a helper function for rendering the state of the cellular automaton using SDL2.
+// render_state.h: Defines helpers for rendering the state of the cellular automaton using SDL2.
+// Worlds are drawn into a framebuffer in software (see framebuffer.h) and uploaded through one
+// streaming texture, so the cost does not grow with the number of living cells.
 #pragma once
 
 #include <SDL.h>
 
+#include "framebuffer.h"
 #include "types.h"
 
 namespace ca {
 
-void render_state(World &world, SDL_Renderer *renderer, SDL_Window *window);
+// Draws worlds into a window through a single streaming texture, which follows the size of the
+// window's drawable area.
+class StreamingRenderer {
+public:
+  StreamingRenderer(SDL_Renderer *renderer, ThreadPool *pool = nullptr);
+  ~StreamingRenderer();
 
-}
+  StreamingRenderer(const StreamingRenderer &) = delete;
+  StreamingRenderer &operator=(const StreamingRenderer &) = delete;
+
+  // draw the view of a world and copy it to the renderer (call SDL_RenderPresent afterwards)
+  void draw(const World &world, const Viewport &view);
+  void draw(const BitWorld &world, const Viewport &view);
+
+  // size of the drawable area, in pixels
+  int width() const { return frame.width; }
+  int height() const { return frame.height; }
+
+private:
+  // recreate the texture and framebuffer if the drawable area changed size
+  void resize();
+  void present();
+
+  SDL_Renderer *renderer;
+  ThreadPool *pool;
+  SDL_Texture *texture{nullptr};
+  Framebuffer frame;
+};
+
+} // namespace ca
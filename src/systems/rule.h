@@ -0,0 +1,80 @@
+// Defines Life-like cellular automaton rules in B/S notation (e.g. "B3/S23" for Conway's Game of Life).
+// A Rule is a literal type, so it can be parsed at compile time and used as a template parameter
+// to give each rule its own specialized kernel.
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace ca {
+
+struct Rule {
+  // bit n is set if a dead cell with n living neighbors is born
+  std::uint16_t birth{0};
+  // bit n is set if a living cell with n living neighbors survives
+  std::uint16_t survival{0};
+
+  // state of a cell in the next generation
+  constexpr bool next(bool alive, int neighbors) const {
+    return ((alive ? survival : birth) >> neighbors) & 1;
+  }
+
+  // format as "B.../S..."
+  std::string to_string() const {
+    std::string s = "B";
+    for (int n = 0; n <= 8; n++) {
+      if ((birth >> n) & 1) s += static_cast<char>('0' + n);
+    }
+    s += "/S";
+    for (int n = 0; n <= 8; n++) {
+      if ((survival >> n) & 1) s += static_cast<char>('0' + n);
+    }
+    return s;
+  }
+
+  constexpr bool operator==(const Rule &other) const = default;
+};
+
+/**
+ * @brief parse a rule in B/S notation, e.g. "B3/S23" or "b36/s23". the B and S parts may
+ * appear in either order, and either may be empty (e.g. "B2/S" for Seeds).
+ *
+ * usable at compile time. throws std::invalid_argument if the string is malformed.
+ */
+constexpr Rule parse_rule(std::string_view text) {
+  Rule rule;
+  bool seen_birth = false;
+  bool seen_survival = false;
+  std::uint16_t *target = nullptr;
+  for (char c : text) {
+    if (c == 'B' || c == 'b') {
+      if (seen_birth) throw std::invalid_argument("rule has more than one B part");
+      seen_birth = true;
+      target = &rule.birth;
+    } else if (c == 'S' || c == 's') {
+      if (seen_survival) throw std::invalid_argument("rule has more than one S part");
+      seen_survival = true;
+      target = &rule.survival;
+    } else if (c == '/') {
+      target = nullptr;
+    } else if (c >= '0' && c <= '8' && target != nullptr) {
+      *target |= static_cast<std::uint16_t>(1 << (c - '0'));
+    } else {
+      throw std::invalid_argument("invalid character in rule: " + std::string(text));
+    }
+  }
+  if (!seen_birth || !seen_survival) {
+    throw std::invalid_argument("rule must have a B and an S part: " + std::string(text));
+  }
+  return rule;
+}
+
+// some well known rules
+constexpr Rule CONWAY = parse_rule("B3/S23");
+constexpr Rule HIGHLIFE = parse_rule("B36/S23");
+constexpr Rule DAY_AND_NIGHT = parse_rule("B3678/S34678");
+constexpr Rule SEEDS = parse_rule("B2/S");
+
+} // namespace ca
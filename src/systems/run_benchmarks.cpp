@@ -6,46 +6,262 @@
 
 #include <iostream>
 #include <vector>
-#include <random>
 #include <memory>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <stdexcept>
 
+#include "autotune.h"
 #include "benchmark.h"
+#include "buffer_pool.h"
+#include "golden_patterns.h"
+#include "memory_usage.h"
+#include "random_world.h"
 #include "types.h"
 
 
+std::vector<std::string> benchmark_names() {
+  return {"gpu_naive",      "cpu_naive",        "cpu_sized",   "cpu_halo",
+          "cpu_bit_packed", "cpu_temporal",     "cpu_hashlife", "cpu_active_tiles",
+          "cpu_sparse",     "cpu_live_cells",   "cpu_parallel", "cpu_decomposed",
+          "cpu_batched",    "auto"};
+}
+
+std::vector<std::unique_ptr<Benchmark>> make_benchmarks(const BenchmarkParams &params,
+                                                        const std::vector<std::string> &names) {
+  auto max_threads = params.num_threads > 0 ? params.num_threads : ca::hardware_threads();
+
+  std::vector<std::unique_ptr<Benchmark>> benchmarks;
+  for (const auto &name : names) {
+    if (name == "gpu_naive") {
+      benchmarks.push_back(std::make_unique<GPUNaive>());
+    } else if (name == "cpu_naive") {
+      benchmarks.push_back(std::make_unique<CPUNaive>());
+    } else if (name == "cpu_sized") {
+      benchmarks.push_back(std::make_unique<CPUSized>());
+    } else if (name == "cpu_batched") {
+      benchmarks.push_back(std::make_unique<CPUBatched>());
+    } else if (name == "cpu_halo") {
+      benchmarks.push_back(std::make_unique<CPUHalo>());
+    } else if (name == "cpu_bit_packed") {
+      benchmarks.push_back(std::make_unique<CPUBitPacked>());
+    } else if (name == "cpu_temporal") {
+      benchmarks.push_back(std::make_unique<CPUTemporal>(params.tile_size, params.tile_generations));
+    } else if (name == "cpu_hashlife") {
+      benchmarks.push_back(std::make_unique<CPUHashLife>(params.hashlife_memory_mb));
+    } else if (name == "cpu_active_tiles") {
+      benchmarks.push_back(std::make_unique<CPUActiveTiles>(params.active_tile_size));
+    } else if (name == "cpu_sparse") {
+      benchmarks.push_back(std::make_unique<CPUSparse>());
+    } else if (name == "cpu_live_cells") {
+      benchmarks.push_back(std::make_unique<CPULiveCells>(params.live_cell_density));
+    } else if (name == "cpu_decomposed") {
+      benchmarks.push_back(std::make_unique<CPUDecomposed>(params.domains_x, params.domains_y));
+    } else if (name == "auto") {
+      benchmarks.push_back(make_auto_benchmark(params));
+    } else if (name == "cpu_parallel") {
+      // multithreaded benchmark at 1, 2, 4, ... threads, up to and including max_threads
+      for (int threads = 1; threads < max_threads; threads *= 2) {
+        benchmarks.push_back(std::make_unique<CPUParallel>(threads, params.pin_threads));
+      }
+      benchmarks.push_back(std::make_unique<CPUParallel>(max_threads, params.pin_threads));
+    } else {
+      std::string known;
+      for (const auto &n : benchmark_names()) {
+        known += (known.empty() ? "" : ", ") + n;
+      }
+      throw std::invalid_argument("unknown benchmark '" + name + "' (known: " + known + ")");
+    }
+  }
+  return benchmarks;
+}
+
+std::string path_with_suffix(const std::string &path, std::string suffix) {
+  for (char &c : suffix) {
+    if (c == '/' || c == '\\' || c == ' ') c = '_';
+  }
+  const size_t slash = path.find_last_of('/');
+  const size_t dot = path.find_last_of('.');
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+    return path + suffix;
+  }
+  return path.substr(0, dot) + suffix + path.substr(dot);
+}
+
+namespace {
+// run every job once on the pool's workers, each worker taking the next job that has not been
+// started. returns the wall clock time of the whole batch.
+double run_jobs_concurrently(ca::ThreadPool &pool, Benchmark &benchmark,
+                             const std::vector<Job> &jobs, std::vector<JobResult> &results) {
+  std::atomic<size_t> next{0};
+  auto start_time = std::chrono::high_resolution_clock::now();
+  pool.run([&](int) {
+    // allocate fresh buffers instead of recycling ones that another worker may have placed on
+    // its own NUMA node
+    const ca::BufferPool::Bypass bypass;
+    for (size_t j = next.fetch_add(1); j < jobs.size(); j = next.fetch_add(1)) {
+      // copy the job on the worker, so that its state (like the buffers the benchmark allocates
+      // in run) is first touched, and so placed, on the NUMA node of the worker's core
+      const Job job = jobs[j];
+      results[j] = benchmark.run(job);
+    }
+  });
+  auto end_time = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count();
+}
+
+// restart the peak resident set size and the pool's high-water mark before a timed run.
+// returns whether the peak resident set size could be reset.
+bool reset_peaks() {
+  ca::BufferPool::shared().reset_peak();
+  return ca::reset_peak_rss();
+}
+
+// the file a benchmark writes for a job: path with the benchmark's label and, when there are
+// several jobs, the job's index appended. empty if path is.
+std::string job_output_path(const std::string &path, const std::string &label, size_t job,
+                            size_t num_jobs) {
+  if (path.empty()) return path;
+  std::string suffix = "_" + label;
+  if (num_jobs > 1) suffix += "_job" + std::to_string(job);
+  return path_with_suffix(path, suffix);
+}
+
+// fill in the measured memory of a job that started at rss_before
+void record_peak_rss(JobResult &result, bool peak_reset, unsigned long rss_before) {
+  result.peak_rss = ca::peak_rss();
+  result.pool_peak_bytes = ca::BufferPool::shared().stats().peak_in_use_bytes;
+  result.peak_rss_growth = result.peak_rss > rss_before ? result.peak_rss - rss_before : 0;
+  result.peak_rss_per_job = peak_reset;
+}
+} // namespace
+
 ParameterBenchmarkSet run_benchmarks(BenchmarkParams params) {
+  // the default set leaves out the unbounded engine, which only matches the others
+  // when the pattern stays away from the edges (see BenchmarkParams::soup_size), and auto,
+  // which runs one of the others
+  std::vector<std::string> names = params.benchmarks;
+  if (names.empty()) {
+    for (const auto &name : benchmark_names()) {
+      if (name != "cpu_sparse" && name != "auto") names.push_back(name);
+    }
+  }
+
+  // open the counters before the benchmarks start their worker threads, so those are counted
+  if (params.perf_counters) {
+    ca::perf_counters();
+  }
+
+  // create instances of the benchmarks
+  std::cout << "Initializing benchmarks..." << std::endl;
+  return run_benchmarks(params, make_benchmarks(params, names));
+}
+
+ParameterBenchmarkSet run_benchmarks(BenchmarkParams params,
+                                     std::vector<std::unique_ptr<Benchmark>> benchmarks) {
   // extract params
   auto width_height = params.width_height;
   auto num_jobs = params.num_jobs;
   auto iterations = params.iterations;
   auto seed = params.seed;
 
-  // create random generator with constant seed
-  std::mt19937 gen(seed);
+  // load the initial state file, if there is one. it overrides the rule when it names one,
+  // and checkpoints override the world size too.
+  ca::LoadedWorld loaded;
+  if (!params.initial_state_file.empty()) {
+    std::cout << "Loading " << params.initial_state_file << "..." << std::endl;
+    loaded = ca::load_world(params.initial_state_file, width_height, width_height);
+    if (loaded.has_rule) params.rule = loaded.rule;
+    params.width_height = loaded.world.width;
+  }
 
   // create the jobs
   std::cout << "Initializing jobs..." << std::endl;
   std::vector<Job> jobs;
   // std::vector<std::vector<JobResult>> job_results;
   std::vector<BenchmarkResult> benchmark_results;
+  // large random worlds are generated by several threads (the result does not depend on how many)
+  const int soup = params.soup_size > 0 && params.soup_size < width_height ? params.soup_size
+                                                                           : width_height;
+  std::unique_ptr<ca::ThreadPool> generator_pool;
+  if (params.initial_state_file.empty() && static_cast<long>(soup) * soup >= (1L << 20)) {
+    generator_pool = std::make_unique<ca::ThreadPool>(params.num_threads, false);
+  }
   for (int i = 0; i < num_jobs; ++i) {
-    // each job gets a random initial state with the specified dimensions
-    ca::World initial_state(width_height, width_height, gen);
+    if (!params.initial_state_file.empty()) {
+      // every job starts from the file
+      jobs.emplace_back(loaded.world, iterations, "World loaded from " + params.initial_state_file,
+                        params.rule);
+      continue;
+    }
+    // each job gets a random initial state with the specified dimensions (its own stream of the
+    // seed), or only a random soup in the center
+    ca::World initial_state =
+        ca::random_world(soup, soup, params.density, seed, i, generator_pool.get());
+    if (soup < width_height) {
+      initial_state = ca::place_pattern(initial_state, width_height, width_height);
+    }
     jobs.emplace_back(
-        initial_state, iterations,
-        "Randomlized world. TODO: string interpolate in the WIDTH, HEIGHT, iterations...");
+        std::move(initial_state), iterations,
+        "Randomlized world. TODO: string interpolate in the WIDTH, HEIGHT, iterations...",
+        params.rule);
+  }
+  for (int j = 0; j < jobs.size(); ++j) {
+    jobs[j].trace_every = params.trace_every;
+    jobs[j].cycle_mode = params.cycle_mode;
+    jobs[j].render_size = params.render_size;
   }
-
-  // create instances of the benchmarks
-  std::cout << "Initializing benchmarks..." << std::endl;
-  std::vector<std::unique_ptr<Benchmark>> benchmarks;
-  benchmarks.push_back(std::make_unique<GPUNaive>());
-  benchmarks.push_back(std::make_unique<CPUNaive>());
 
   // create benchmark results
   for (auto& benchmark : benchmarks) {
-    BenchmarkResult r(std::vector<JobResult>(), benchmark->get_description());
-    benchmark_results.push_back(r);
+    BenchmarkResult r(std::vector<JobResult>(), benchmark->get_description(),
+                      benchmark->get_num_threads());
+    benchmark_results.push_back(std::move(r));
+  }
+
+  // check each benchmark against the golden patterns, once per process
+  int validation_failures = 0;
+  if (params.check_golden) {
+    static std::set<std::string> checked;
+    for (auto &benchmark : benchmarks) {
+      if (!checked.insert(benchmark->get_name()).second) continue;
+      std::cout << "Checking " << benchmark->get_name() << " against the golden patterns..."
+                << std::endl;
+      for (const auto &failure : ca::check_golden_patterns(*benchmark)) {
+        std::cerr << "Golden pattern mismatch for " << benchmark->get_name() << ": " << failure
+                  << std::endl;
+        validation_failures++;
+      }
+    }
+  }
+
+  // hardware counters, if requested
+  ca::PerfCounters *counters = params.perf_counters ? &ca::perf_counters() : nullptr;
+  if (counters != nullptr && !counters->available()) {
+    std::cerr << "Performance counters unavailable (" << counters->unavailable_reason()
+              << "), continuing without them" << std::endl;
+  }
+
+  // workers for running jobs concurrently. created after the counters are opened, so that
+  // they are counted.
+  const int job_threads = params.job_threads > 0 ? params.job_threads : ca::hardware_threads();
+  std::unique_ptr<ca::ThreadPool> job_pool;
+  if (job_threads > 1) {
+    job_pool = std::make_unique<ca::ThreadPool>(job_threads, params.pin_threads);
+  }
+
+  // names the files a benchmark writes are labelled with. a name shared by several benchmarks
+  // (like cpu_parallel at every thread count) gets the benchmark's number too.
+  std::vector<std::string> labels;
+  for (int i = 0; i < benchmarks.size(); ++i) {
+    const std::string name = benchmarks[i]->get_name();
+    int same_name = 0;
+    for (auto &other : benchmarks) {
+      same_name += other->get_name() == name;
+    }
+    labels.push_back(same_name > 1 ? name + "_" + std::to_string(i + 1) : name);
   }
 
   // run the benchmarks
@@ -55,31 +271,211 @@ ParameterBenchmarkSet run_benchmarks(BenchmarkParams params) {
     // grab the current benchmark and results instance
     auto &benchmark = *benchmarks[i];
     auto &results = benchmark_results[i].results;
+    const bool batched = benchmark.is_batched();
+    const bool concurrent = !batched && job_pool != nullptr && benchmark.is_reentrant();
+    const int repetitions = std::max(1, params.repetitions);
+    // only the last timed repetition of a job records snapshots and renders frames, into files of
+    // this benchmark's own, so that warmups, other repetitions and other benchmarks do not
+    // overwrite them
+    auto set_outputs = [&](size_t j, bool enabled) {
+      jobs[j].record_every = enabled ? params.record_every : 0;
+      jobs[j].record_file =
+          enabled ? job_output_path(params.record_file, labels[i], j, jobs.size()) : "";
+      jobs[j].render_every = enabled ? params.render_every : 0;
+      jobs[j].render_file =
+          enabled ? job_output_path(params.render_file, labels[i], j, jobs.size()) : "";
+    };
+    // drop the buffers the previous benchmarks left in the pool, so that the resident size
+    // while this one runs counts its own buffers (kept idle between its runs) and not theirs
+    ca::BufferPool::shared().trim();
 
-    // for each job,
+    // duration of every timed repetition of each job, and the result of its last repetition
+    std::vector<std::vector<double>> job_durations(jobs.size());
+    std::vector<ca::PerfCounts> job_perf(jobs.size());
+    results.clear();
+    results.resize(jobs.size());
+    // wall clock time of each timed pass over all jobs
+    std::vector<double> batch_seconds(repetitions, 0.0);
+
+    if (batched) {
+      std::cout << "Running " << jobs.size() << " jobs as a batch for benchmark " << (i + 1)
+                << " of " << benchmarks.size() << std::endl;
+      // untimed warmup passes
+      for (int w = 0; w < params.warmup_runs; ++w) {
+        benchmark.run_batch(jobs);
+      }
+      // timed passes. like concurrent passes, counters and the peak cover the whole batch.
+      ca::PerfCounts perf;
+      for (int r = 0; r < repetitions; ++r) {
+        if (r == repetitions - 1) {
+          for (size_t j = 0; j < jobs.size(); ++j) set_outputs(j, true);
+        }
+        const bool peak_reset = reset_peaks();
+        const unsigned long rss_before = ca::current_rss();
+        if (counters != nullptr) counters->start();
+        std::vector<JobResult> batch = benchmark.run_batch(jobs);
+        if (counters != nullptr) counters->stop(perf);
+        for (int j = 0; j < jobs.size(); ++j) {
+          results[j] = std::move(batch[j]);
+          job_durations[j].push_back(results[j].duration);
+          record_peak_rss(results[j], peak_reset, rss_before);
+          // each result holds its share of the batch
+          batch_seconds[r] += results[j].duration;
+        }
+      }
+      for (std::int64_t *count :
+           {&perf.cycles, &perf.instructions, &perf.llc_misses, &perf.branch_misses}) {
+        if (*count >= 0) *count /= static_cast<std::int64_t>(jobs.size());
+      }
+      job_perf.assign(jobs.size(), perf);
+    } else if (concurrent) {
+      std::cout << "Running " << jobs.size() << " jobs on " << job_threads
+                << " workers for benchmark " << (i + 1) << " of " << benchmarks.size()
+                << std::endl;
+      // untimed warmup passes
+      std::vector<JobResult> warmup_results(jobs.size());
+      for (int w = 0; w < params.warmup_runs; ++w) {
+        run_jobs_concurrently(*job_pool, benchmark, jobs, warmup_results);
+      }
+      // timed passes. counters cover the whole pass and are split evenly between the jobs.
+      ca::PerfCounts perf;
+      for (int r = 0; r < repetitions; ++r) {
+        if (r == repetitions - 1) {
+          for (size_t j = 0; j < jobs.size(); ++j) set_outputs(j, true);
+        }
+        // the jobs of a pass share the process, so they all get the peak of the whole pass
+        const bool peak_reset = reset_peaks();
+        const unsigned long rss_before = ca::current_rss();
+        if (counters != nullptr) counters->start();
+        batch_seconds[r] = run_jobs_concurrently(*job_pool, benchmark, jobs, results);
+        if (counters != nullptr) counters->stop(perf);
+        for (int j = 0; j < jobs.size(); ++j) {
+          job_durations[j].push_back(results[j].duration);
+          record_peak_rss(results[j], peak_reset, rss_before);
+        }
+      }
+      for (std::int64_t *count :
+           {&perf.cycles, &perf.instructions, &perf.llc_misses, &perf.branch_misses}) {
+        if (*count >= 0) *count /= static_cast<std::int64_t>(jobs.size());
+      }
+      job_perf.assign(jobs.size(), perf);
+    } else {
+      // for each job,
+      for (int j = 0; j < jobs.size(); ++j) {
+        // grab the current job
+        auto &job = jobs[j];
+        std::cout << "Running job " << (j + 1) << " of " << jobs.size() << " for benchmark "
+                  << (i + 1) << " of " << benchmarks.size() << std::endl;
+        // untimed warmup runs
+        for (int w = 0; w < params.warmup_runs; ++w) {
+          benchmark.run(job);
+        }
+        // timed runs. the result of the last one is kept.
+        for (int r = 0; r < repetitions; ++r) {
+          if (r == repetitions - 1) set_outputs(j, true);
+          const bool peak_reset = reset_peaks();
+          const unsigned long rss_before = ca::current_rss();
+          if (counters != nullptr) counters->start();
+          results[j] = benchmark.run(job);
+          if (counters != nullptr) counters->stop(job_perf[j]);
+          record_peak_rss(results[j], peak_reset, rss_before);
+          job_durations[j].push_back(results[j].duration);
+          // jobs run back to back, so a pass takes as long as its jobs together
+          batch_seconds[r] += results[j].duration;
+        }
+      }
+    }
+
+    // the next benchmark's warmups do not write either
+    for (size_t j = 0; j < jobs.size(); ++j) set_outputs(j, false);
+
+    // every timed repetition of every job, for the statistics
+    std::vector<double> samples;
+    double cell_updates = 0;
+    double batch_cell_updates = 0;
+    double batch_generations = 0;
     for (int j = 0; j < jobs.size(); ++j) {
-      // grab the current job
       auto &job = jobs[j];
-      std::cout << "Running job " << (j + 1) << " of " << jobs.size() << " for benchmark " << (i + 1)
-                << " of " << benchmarks.size() << std::endl;
-      // run the job and push back the result
-      results.push_back(benchmark.run(job));
+      auto &result = results[j];
+      samples.insert(samples.end(), job_durations[j].begin(), job_durations[j].end());
+      result.duration = summarize_durations(job_durations[j], 0).median;
+      result.durations = std::move(job_durations[j]);
+      cell_updates = static_cast<double>(job.initial_state.width) * job.initial_state.height *
+                     job.iterations;
+      batch_cell_updates += cell_updates;
+      batch_generations += job.iterations;
+      if (counters != nullptr) {
+        // report the counts of a single run
+        ca::PerfCounts &perf = job_perf[j];
+        if (!concurrent) {
+          for (std::int64_t *count :
+               {&perf.cycles, &perf.instructions, &perf.llc_misses, &perf.branch_misses}) {
+            if (*count >= 0) *count /= repetitions;
+          }
+        }
+        perf.enabled = true;
+        perf.cell_updates = cell_updates;
+        perf.unavailable_reason = counters->unavailable_reason();
+        result.perf = perf;
+      }
     }
+    benchmark_results[i].stats = summarize_durations(samples, cell_updates);
+    benchmark_results[i].throughput =
+        summarize_throughput(batch_seconds, static_cast<int>(jobs.size()), batch_generations,
+                             batch_cell_updates, concurrent ? job_threads : 1);
 
     // print results
-    // for now, just print the results as-is.
-    // TODO: compute mean and std. maybe export to csv to be processed by a python script
-    // maybe we use matplotlib to generate some histograms later...
+    const auto &stats = benchmark_results[i].stats;
     std::cout << "Benchmark " << (i + 1) << ": " << benchmark.get_description() << std::endl;
     for (int j = 0; j < jobs.size(); ++j) {
-      // auto &job = jobs[j]; // TODO: maybe jobs should have descriptions?
       auto &result = results[j];
       std::cout << "Job " << (j + 1) << " Duration: " << result.duration
-                << " seconds, Memory: " << result.memory_required << " bytes." << std::endl;
+                << " seconds, Peak RSS: " << result.peak_rss << " bytes." << std::endl;
     }
+    std::cout << "Median: " << stats.median << " s, p5: " << stats.p5 << " s, p95: " << stats.p95
+              << " s, stddev: " << stats.stddev << " s, " << stats.cells_per_second
+              << " cells/s (" << stats.samples << " samples)" << std::endl;
+    const auto &throughput = benchmark_results[i].throughput;
+    std::cout << "Throughput: " << throughput.jobs_per_second << " jobs/s, "
+              << throughput.cells_per_second << " cells/s, "
+              << throughput.world_generations_per_second << " world-generations/s ("
+              << throughput.job_threads << " jobs at once)" << std::endl;
     std::cout << std::endl; // additional newline for clarity
   }
 
+  // compute scaling efficiency of the multithreaded benchmarks relative to their single thread run
+  double single_thread_duration = 0;
+  for (auto &benchmark_result : benchmark_results) {
+    if (benchmark_result.num_threads == 1) {
+      single_thread_duration = benchmark_result.stats.median;
+    }
+  }
+  for (auto &benchmark_result : benchmark_results) {
+    if (benchmark_result.num_threads > 0 && benchmark_result.stats.median > 0) {
+      benchmark_result.scaling_efficiency =
+          single_thread_duration / (benchmark_result.stats.median * benchmark_result.num_threads);
+      std::cout << "Scaling efficiency at " << benchmark_result.num_threads
+                << " threads: " << benchmark_result.scaling_efficiency << std::endl;
+    }
+  }
+
+  // export the traces
+  if (params.trace_every > 0 && !params.trace_file.empty()) {
+    std::vector<TraceSource> sources;
+    for (int i = 0; i < benchmarks.size(); ++i) {
+      // the multithreaded benchmark appears once per thread count
+      std::string name = benchmarks[i]->get_name();
+      if (benchmark_results[i].num_threads > 0) {
+        name += "@" + std::to_string(benchmark_results[i].num_threads);
+      }
+      for (int j = 0; j < benchmark_results[i].results.size(); ++j) {
+        sources.push_back(TraceSource{name, j, &benchmark_results[i].results[j].trace});
+      }
+    }
+    write_traces(params.trace_file, sources);
+    std::cout << "Wrote traces to " << params.trace_file << std::endl;
+  }
+
   // validate results match across benchmarks
   std::cout << "Validating results..." << std::endl;
   bool results_match = true;
@@ -93,12 +489,18 @@ ParameterBenchmarkSet run_benchmarks(BenchmarkParams params) {
       // compare neighboring results.
       // these are two results from two benchmarks, but
       // from the same job, so we expect the exact same result.
-      auto &result1 = results1[result_index].final_state;
-      auto &result2 = results2[result_index].final_state;
-      // compare the results (using custom (!=) operator)
+      // a job that stopped at its first repeated state ended on a different generation
+      if (results1[result_index].cycles.stopped_early ||
+          results2[result_index].cycles.stopped_early) {
+        continue;
+      }
+      auto &result1 = results1[result_index].digest;
+      auto &result2 = results2[result_index].digest;
+      // compare the digests (hash and population) of the final states
       if (result1 != result2) {
         std::cerr << "Results for job " << (result_index + 1) << " do not match across benchmarks!" << std::endl;
         results_match = false;
+        validation_failures++;
       }
     }
   }
@@ -107,7 +509,11 @@ ParameterBenchmarkSet run_benchmarks(BenchmarkParams params) {
     std::cout << "All results match across benchmarks!" << std::endl;
   }
 
-  // TODO: std::move?
-  ParameterBenchmarkSet bset(params, benchmark_results);
-  return bset;
+  // the pool is shared by every sweep point, so its counters accumulate over the whole sweep
+  const ca::BufferPoolStats pool_stats = ca::BufferPool::shared().stats();
+  std::cout << "Buffer pool: " << pool_stats.hits << " reused, " << pool_stats.misses
+            << " allocated, " << pool_stats.idle_bytes << " bytes idle" << std::endl;
+  ParameterBenchmarkSet set(std::move(params), std::move(benchmark_results), pool_stats);
+  set.validation_failures = validation_failures;
+  return set;
 }
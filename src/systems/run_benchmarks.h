@@ -6,15 +6,38 @@
 
 #include <vector>
 #include <fstream>
+#include <sstream>
+#include <memory>
 
 #include "benchmark.h"
 #include "json_helper.h"
+#include "temporal_blocking.h"
+#include "hashlife.h"
+#include "live_cells.h"
+#include "active_tiles.h"
+#include "world_io.h"
+#include "random_world.h"
+#include "domain_decomposition.h"
+#include "cycle_detection.h"
+#include "tuning_cache.h"
 
 // default parameters
 constexpr int WIDTH_HEIGHT = 1 << 10;
 constexpr int NUM_JOBS = 1 << 3;
 constexpr int ITERATIONS = 1 << 9;
 constexpr unsigned long SEED = 0;
+// 0 means one thread per hardware thread
+constexpr int NUM_THREADS = 0;
+constexpr bool PIN_THREADS = false;
+// untimed runs of each job before the timed repetitions (to warm caches, page in memory, etc.)
+constexpr int WARMUP_RUNS = 1;
+// timed runs of each job
+constexpr int REPETITIONS = 3;
+// jobs run at once. 1 runs them one after another.
+constexpr int JOB_THREADS = 1;
+// TILE_SIZE and TILE_GENERATIONS defaults come from temporal_blocking.h,
+// HASHLIFE_MEMORY_MB from hashlife.h, ACTIVE_TILE_SIZE from active_tiles.h, LIVE_CELL_DENSITY from
+// live_cells.h, DENSITY from random_world.h, DOMAINS_X and DOMAINS_Y from domain_decomposition.h
 
 // struct of the parameters describing one benchmark
 struct BenchmarkParams {
@@ -22,6 +45,74 @@ struct BenchmarkParams {
     int num_jobs{NUM_JOBS};
     int iterations{ITERATIONS};
     unsigned long seed{SEED};
+    int warmup_runs{WARMUP_RUNS};
+    int repetitions{REPETITIONS};
+    // names of the benchmarks to run (see Benchmark::get_name). empty runs the default set.
+    std::vector<std::string> benchmarks{};
+    // maximum thread count for the multithreaded benchmarks. they are run at every
+    // power of two below this, as well as at this count, to measure scaling.
+    int num_threads{NUM_THREADS};
+    // pin each worker thread to its own core
+    bool pin_threads{PIN_THREADS};
+    // number of jobs run at once, each on its own worker (0 means one per hardware thread).
+    // 1 measures latency; more measures throughput. the workers are pinned with pin_threads.
+    int job_threads{JOB_THREADS};
+    // tile edge length (in cells) and generations per block for the temporally blocked benchmark
+    int tile_size{ca::TILE_SIZE};
+    int tile_generations{ca::TILE_GENERATIONS};
+    // soft memory cap for the HashLife node store, in megabytes
+    int hashlife_memory_mb{ca::HASHLIFE_MEMORY_MB};
+    // tile edge length (in cells) for the active-tile benchmark
+    int active_tile_size{ca::ACTIVE_TILE_SIZE};
+    // fraction of living cells above which the live cell list benchmark uses the grid
+    double live_cell_density{ca::LIVE_CELL_DENSITY};
+    // grid of subdomains (one process each) for the multi-process benchmark
+    int domains_x{ca::DOMAINS_X};
+    int domains_y{ca::DOMAINS_Y};
+    // birth/survival rule applied by every benchmark (see ca::parse_rule)
+    ca::Rule rule{ca::CONWAY};
+    // checkpoint, RLE or plaintext file to start every job from (see ca::load_world).
+    // empty means random worlds. patterns are centered in a width_height world.
+    std::string initial_state_file{};
+    // edge length of the random soup in the center of each random world. 0 (or anything at least
+    // width_height) randomizes the whole world. small soups on large worlds never reach the
+    // edges, so the unbounded engine can be validated against the toroidal ones.
+    int soup_size{0};
+    // fraction of living cells in random worlds (see ca::random_world)
+    double density{ca::DENSITY};
+    // read hardware performance counters around each timed run (see perf_counters.h)
+    bool perf_counters{false};
+    // run each benchmark against the golden patterns (see golden_patterns.h) before timing it
+    bool check_golden{true};
+    // take a timestamp every this many generations of each run (0 disables tracing). the JSON
+    // gets a per-generation latency summary of each job.
+    int trace_every{0};
+    // file the traces are written to (CSV if it ends in .csv, binary otherwise, see trace.h).
+    // empty only keeps the summaries.
+    std::string trace_file{};
+    // record a snapshot every this many generations (0 disables recording), in the engines that
+    // support it (see SnapshotRecorder). each job gets its own file when there are several.
+    int record_every{0};
+    std::string record_file{"recording.caw"};
+    // draw a render_size x render_size frame of the whole world every this many generations (0
+    // disables rendering), in the engines that support it (see ca::HeadlessRenderer). frames are
+    // written to render_file (PNG if it ends in .png, PPM otherwise) with the generation appended,
+    // or only drawn if it is empty. each job gets its own files when there are several.
+    int render_every{0};
+    int render_size{512};
+    std::string render_file{};
+    // reduce every generation and detect still lifes and oscillators, in the engines that
+    // support it: "off", "detect", "stop" (jobs that stop early are not validated) or
+    // "fast_forward" (see ca::CycleMode)
+    ca::CycleMode cycle_mode{ca::CycleMode::OFF};
+    // instead of running the benchmarks, time short runs of every engine configuration and save
+    // the fastest for this width_height and iterations in tuning_cache (see autotune.h)
+    bool autotune{false};
+    // generations of each trial run when tuning (fewer if iterations is smaller)
+    int tune_iterations{ca::TUNE_ITERATIONS};
+    // tuning cache written by autotune and read by the auto benchmark. empty means this host's
+    // cache in the working directory (see ca::TuningCache::default_path).
+    std::string tuning_cache{};
 
     std::string to_json() const {
         std::stringstream ss;
@@ -29,7 +120,42 @@ struct BenchmarkParams {
         ss << "\"width_height\": " << width_height << ",";
         ss << "\"num_jobs\": " << num_jobs << ",";
         ss << "\"iterations\": " << iterations << ",";
-        ss << "\"seed\": " << seed;
+        ss << "\"seed\": " << seed << ",";
+        ss << "\"warmup_runs\": " << warmup_runs << ",";
+        ss << "\"repetitions\": " << repetitions << ",";
+        ss << "\"benchmarks\": [";
+        for (size_t i = 0; i < benchmarks.size(); ++i) {
+            if (i > 0) ss << ",";
+            ss << "\"" << escape_json_string(benchmarks[i]) << "\"";
+        }
+        ss << "],";
+        ss << "\"num_threads\": " << num_threads << ",";
+        ss << "\"pin_threads\": " << (pin_threads ? "true" : "false") << ",";
+        ss << "\"job_threads\": " << job_threads << ",";
+        ss << "\"tile_size\": " << tile_size << ",";
+        ss << "\"tile_generations\": " << tile_generations << ",";
+        ss << "\"hashlife_memory_mb\": " << hashlife_memory_mb << ",";
+        ss << "\"active_tile_size\": " << active_tile_size << ",";
+        ss << "\"live_cell_density\": " << live_cell_density << ",";
+        ss << "\"domains_x\": " << domains_x << ",";
+        ss << "\"domains_y\": " << domains_y << ",";
+        ss << "\"rule\": \"" << rule.to_string() << "\",";
+        ss << "\"initial_state_file\": \"" << escape_json_string(initial_state_file) << "\",";
+        ss << "\"soup_size\": " << soup_size << ",";
+        ss << "\"density\": " << density << ",";
+        ss << "\"perf_counters\": " << (perf_counters ? "true" : "false") << ",";
+        ss << "\"check_golden\": " << (check_golden ? "true" : "false") << ",";
+        ss << "\"trace_every\": " << trace_every << ",";
+        ss << "\"trace_file\": \"" << escape_json_string(trace_file) << "\",";
+        ss << "\"record_every\": " << record_every << ",";
+        ss << "\"record_file\": \"" << escape_json_string(record_file) << "\",";
+        ss << "\"render_every\": " << render_every << ",";
+        ss << "\"render_size\": " << render_size << ",";
+        ss << "\"render_file\": \"" << escape_json_string(render_file) << "\",";
+        ss << "\"cycle_mode\": \"" << ca::to_string(cycle_mode) << "\",";
+        ss << "\"autotune\": " << (autotune ? "true" : "false") << ",";
+        ss << "\"tune_iterations\": " << tune_iterations << ",";
+        ss << "\"tuning_cache\": \"" << escape_json_string(tuning_cache) << "\"";
         ss << "}";
         return ss.str();
     }
@@ -39,11 +165,18 @@ struct BenchmarkParams {
 struct ParameterBenchmarkSet {
     BenchmarkParams params;
     std::vector<BenchmarkResult> benchmark_types;
+    // counters of the shared buffer pool once this parameter set ran (see ca::BufferPool)
+    ca::BufferPoolStats buffer_pool{};
+    // jobs whose final states differ between benchmarks, plus golden pattern mismatches. any
+    // fails the run.
+    int validation_failures{0};
 
     std::string to_json() const {
         std::stringstream ss;
         ss << "{";
         ss << "\"parameters\": " << params.to_json() << ",";
+        ss << "\"buffer_pool\": " << buffer_pool.to_json() << ",";
+        ss << "\"validation_failures\": " << validation_failures << ",";
         ss << "\"benchmark_types\": [";
         for (size_t i = 0; i < benchmark_types.size(); ++i) {
             if (i > 0) ss << ",";
@@ -79,5 +212,20 @@ struct ParameterSweep {
     }
 };
 
-// Runs all benchmarks
+// insert a suffix before a path's extension (e.g. trace.csv becomes trace_1024.csv), replacing
+// characters that are awkward in file names
+std::string path_with_suffix(const std::string &path, std::string suffix);
+
+// Names accepted by make_benchmarks, in the order of the default set
+std::vector<std::string> benchmark_names();
+// Creates the named benchmarks. cpu_parallel expands to one benchmark per power of two thread
+// count up to params.num_threads, and auto reads the tuning cache (see make_auto_benchmark).
+// Throws std::invalid_argument for unknown names.
+std::vector<std::unique_ptr<Benchmark>> make_benchmarks(const BenchmarkParams &params,
+                                                        const std::vector<std::string> &names);
+
+// Runs the benchmarks named in params.benchmarks (or the default set, if empty)
 ParameterBenchmarkSet run_benchmarks(BenchmarkParams params);
+// Runs only the given benchmarks
+ParameterBenchmarkSet run_benchmarks(BenchmarkParams params,
+                                     std::vector<std::unique_ptr<Benchmark>> benchmarks);
@@ -0,0 +1,53 @@
+// Defines byte-per-cell CPU kernels specialized for the world's size: fully fixed sizes for the
+// common power-of-two worlds, mask-based wrapping for any other power of two, and the generic
+// modulo wrap otherwise, along with a dispatcher that picks one at runtime.
+#include "sized_kernels.h"
+
+namespace ca {
+
+template <typename Size>
+void update_state_sized(const World &read, World &write, Rule rule, Size size) {
+  const int width = size.width();
+  const int height = size.height();
+  const cell_t *src = read.state.data();
+  cell_t *dst = write.state.data();
+  // the rule as plain integers, so that the select and the variable shift vectorize
+  const unsigned birth = rule.birth;
+  const unsigned survival = rule.survival;
+
+  for (int y = 0; y < height; y++) {
+    // wrap vertically once per row
+    const cell_t *up = src + static_cast<size_t>(size.wrap_y(y - 1)) * width;
+    const cell_t *mid = src + static_cast<size_t>(y) * width;
+    const cell_t *down = src + static_cast<size_t>(size.wrap_y(y + 1)) * width;
+    cell_t *out = dst + static_cast<size_t>(y) * width;
+
+    auto cell = [&](int x, int west, int east) -> cell_t {
+      const unsigned neighbors = up[west] + up[x] + up[east] + mid[west] + mid[east] +
+                                 down[west] + down[x] + down[east];
+      return ((mid[x] ? survival : birth) >> neighbors) & 1;
+    };
+    // only the first and last cells of a row wrap horizontally
+    out[0] = cell(0, size.wrap_x(-1), size.wrap_x(1));
+    for (int x = 1; x < width - 1; x++) {
+      out[x] = cell(x, x - 1, x + 1);
+    }
+    if (width > 1) out[width - 1] = cell(width - 1, width - 2, size.wrap_x(width));
+  }
+}
+
+std::string size_policy_name(int width, int height) {
+  return with_size_policy(width, height, [](auto size) { return size.name(); });
+}
+
+// every policy with_size_policy can pick
+template void update_state_sized(const World &, World &, Rule, FixedSize<128, 128>);
+template void update_state_sized(const World &, World &, Rule, FixedSize<256, 256>);
+template void update_state_sized(const World &, World &, Rule, FixedSize<512, 512>);
+template void update_state_sized(const World &, World &, Rule, FixedSize<1024, 1024>);
+template void update_state_sized(const World &, World &, Rule, FixedSize<2048, 2048>);
+template void update_state_sized(const World &, World &, Rule, FixedSize<4096, 4096>);
+template void update_state_sized(const World &, World &, Rule, PowerOfTwoSize);
+template void update_state_sized(const World &, World &, Rule, GenericSize);
+
+} // namespace ca
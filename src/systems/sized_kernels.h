@@ -0,0 +1,91 @@
+// Defines byte-per-cell CPU kernels specialized for the world's size: fully fixed sizes for the
+// common power-of-two worlds, mask-based wrapping for any other power of two, and the generic
+// modulo wrap otherwise, along with a dispatcher that picks one at runtime.
+#pragma once
+
+#include <string>
+
+#include "rule.h"
+#include "types.h"
+
+namespace ca {
+
+// Size policies. Each gives the world's dimensions and wraps a coordinate that is at most one
+// cell outside the world back into it.
+
+// Dimensions known at compile time: the row stride is a constant, the trip count of the row loop
+// is known (so it can be unrolled), and the wrap compiles to a mask or a multiply.
+template <int W, int H>
+struct FixedSize {
+  static constexpr int width() { return W; }
+  static constexpr int height() { return H; }
+  static constexpr int wrap_x(int x) { return (x + W) % W; }
+  static constexpr int wrap_y(int y) { return (y + H) % H; }
+  static std::string name() { return "fixed_" + std::to_string(W) + "x" + std::to_string(H); }
+};
+
+// Power-of-two dimensions known at runtime: the wrap is a bitwise and.
+struct PowerOfTwoSize {
+  int w, h;
+  int width() const { return w; }
+  int height() const { return h; }
+  int wrap_x(int x) const { return x & (w - 1); }
+  int wrap_y(int y) const { return y & (h - 1); }
+  static std::string name() { return "power_of_two"; }
+};
+
+// Any dimensions: the wrap is a modulo, as in update_state.
+struct GenericSize {
+  int w, h;
+  int width() const { return w; }
+  int height() const { return h; }
+  int wrap_x(int x) const { return (x + w) % w; }
+  int wrap_y(int y) const { return (y + h) % h; }
+  static std::string name() { return "generic"; }
+};
+
+/**
+ * @brief perform one iteration of a life-like rule with the kernel for the given size policy
+ *
+ * instantiated (in sized_kernels.cpp) for every policy with_size_policy can pick.
+ *
+ * @param read the current state of the world, of the policy's dimensions
+ * @param write the next state of the world
+ * @param rule the birth/survival rule to apply
+ * @param size the size policy
+ */
+template <typename Size>
+void update_state_sized(const World &read, World &write, Rule rule, Size size);
+
+constexpr bool is_power_of_two(int n) {
+  return n > 0 && (n & (n - 1)) == 0;
+}
+
+/**
+ * @brief call f with the most specialized size policy for a width x height world: a FixedSize
+ * for the square power-of-two worlds from 128 to 4096, a PowerOfTwoSize for other power-of-two
+ * dimensions, or a GenericSize for anything else.
+ */
+template <typename F>
+decltype(auto) with_size_policy(int width, int height, F &&f) {
+  if (width == height) {
+    switch (width) {
+    case 128: return f(FixedSize<128, 128>{});
+    case 256: return f(FixedSize<256, 256>{});
+    case 512: return f(FixedSize<512, 512>{});
+    case 1024: return f(FixedSize<1024, 1024>{});
+    case 2048: return f(FixedSize<2048, 2048>{});
+    case 4096: return f(FixedSize<4096, 4096>{});
+    default: break;
+    }
+  }
+  if (is_power_of_two(width) && is_power_of_two(height)) {
+    return f(PowerOfTwoSize{width, height});
+  }
+  return f(GenericSize{width, height});
+}
+
+// name of the kernel variant with_size_policy picks for a width x height world
+std::string size_policy_name(int width, int height);
+
+} // namespace ca
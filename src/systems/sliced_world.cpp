@@ -0,0 +1,59 @@
+// Defines a bit-sliced batch of same-sized worlds: each cell is one machine word holding that cell
+// in up to 64 independent worlds, one bit per world. The word kernels of bit_world.h then advance
+// every world of the batch at once, with the same branch-free circuit.
+#include "sliced_world.h"
+
+namespace ca {
+
+SlicedWorld::SlicedWorld(int width, int height)
+    : cells(static_cast<size_t>(width) * height, 0), width(width), height(height) {}
+
+void SlicedWorld::pack(const World &world, int k) {
+  const word_t bit = word_t{1} << k;
+  const size_t size = cells.size();
+  for (size_t i = 0; i < size; ++i) {
+    // branch-free: clear the slot, then set it from the cell
+    cells[i] = (cells[i] & ~bit) | (static_cast<word_t>(world.state[i] & 1) << k);
+  }
+}
+
+World SlicedWorld::unpack(int k) const {
+  World world(width, height);
+  const size_t size = cells.size();
+  for (size_t i = 0; i < size; ++i) {
+    world.state[i] = static_cast<cell_t>((cells[i] >> k) & 1);
+  }
+  return world;
+}
+
+namespace {
+template <typename Kernel>
+void update_rows(const SlicedWorld &read, SlicedWorld &write, const Kernel &kernel) {
+  const int width = read.width;
+  const int height = read.height;
+  for (int y = 0; y < height; ++y) {
+    const word_t *north = &read.cells[static_cast<size_t>((y + height - 1) % height) * width];
+    const word_t *row = &read.cells[static_cast<size_t>(y) * width];
+    const word_t *south = &read.cells[static_cast<size_t>((y + 1) % height) * width];
+    word_t *out = &write.cells[static_cast<size_t>(y) * width];
+
+    // the neighbors of each cell are whole words, so every world of the batch is updated at once
+    auto cell = [&](int x, int west, int east) {
+      return kernel(north[west], north[x], north[east], row[west], row[x], row[east],
+                    south[west], south[x], south[east]);
+    };
+    // only the first and last cells wrap, so the loop over the others vectorizes
+    out[0] = cell(0, width - 1, width > 1 ? 1 : 0);
+    for (int x = 1; x < width - 1; ++x) {
+      out[x] = cell(x, x - 1, x + 1);
+    }
+    if (width > 1) out[width - 1] = cell(width - 1, width - 2, 0);
+  }
+}
+} // namespace
+
+void update_sliced_state(const SlicedWorld &read, SlicedWorld &write, Rule rule) {
+  with_rule_kernel(rule, [&](const auto &kernel) { update_rows(read, write, kernel); });
+}
+
+} // namespace ca
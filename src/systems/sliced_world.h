@@ -0,0 +1,36 @@
+// Defines a bit-sliced batch of same-sized worlds: each cell is one machine word holding that cell
+// in up to 64 independent worlds, one bit per world. The word kernels of bit_world.h then advance
+// every world of the batch at once, with the same branch-free circuit.
+#pragma once
+
+#include "bit_world.h"
+#include "buffer_pool.h"
+#include "rule.h"
+#include "types.h"
+
+namespace ca {
+
+// worlds in one batch: one per bit of a word
+constexpr int WORLDS_PER_SLICE = CELLS_PER_WORD;
+
+// Up to WORLDS_PER_SLICE worlds of the same size, interleaved. Bit k of cells[y * width + x] is
+// cell (x, y) of world k. Unused worlds are all dead.
+struct SlicedWorld {
+  pooled_vector<word_t> cells;
+  int width{0};
+  int height{0};
+
+  SlicedWorld() = default;
+  // allocate a batch of all-dead worlds of the given dimensions
+  SlicedWorld(int width, int height);
+
+  // copy a world into slot k (0 <= k < WORLDS_PER_SLICE). it must be width x height.
+  void pack(const World &world, int k);
+  // extract the world in slot k
+  World unpack(int k) const;
+};
+
+// perform one iteration of the given rule on every world of a batch
+void update_sliced_state(const SlicedWorld &read, SlicedWorld &write, Rule rule);
+
+} // namespace ca
@@ -0,0 +1,175 @@
+// Defines a pipelined recorder for snapshots of every Nth generation. The simulation thread only
+// packs a generation into a recycled buffer; a background thread compresses it and appends it to
+// the recording with large sequential writes, so the simulation only waits for the disk when
+// every buffer is still in flight.
+#include "snapshot_recorder.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "world_io.h"
+
+namespace ca {
+
+namespace {
+double seconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+SnapshotRecorder::SnapshotRecorder(const std::string &path, int width, int height, Rule rule,
+                                   int queue_depth)
+    : path(path), width(width), height(height),
+      words_per_row((width + CELLS_PER_WORD - 1) / CELLS_PER_WORD), rule(rule) {
+  fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("failed to create " + path + ": " + std::strerror(errno));
+  }
+  const size_t words = static_cast<size_t>(words_per_row) * height;
+  snapshots.resize(std::max(queue_depth, 1));
+  for (size_t i = 0; i < snapshots.size(); i++) {
+    snapshots[i].words.resize(words);
+    free_buffers.push_back(static_cast<int>(i));
+  }
+  encoded.resize(words + 1);
+  output.reserve(SNAPSHOT_WRITE_BYTES + sizeof(CheckpointHeader) + words * sizeof(word_t));
+  writer = std::thread(&SnapshotRecorder::writer_loop, this);
+}
+
+SnapshotRecorder::~SnapshotRecorder() {
+  if (!finished) {
+    try {
+      finish();
+    } catch (const std::exception &) {
+      // nothing to report the error to
+    }
+  }
+}
+
+SnapshotRecorder::Snapshot &SnapshotRecorder::acquire() {
+  const auto start = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(mutex);
+  free_cv.wait(lock, [this] { return !free_buffers.empty(); });
+  Snapshot &snapshot = snapshots[free_buffers.front()];
+  free_buffers.pop_front();
+  stats.stall_seconds += seconds_since(start);
+  return snapshot;
+}
+
+void SnapshotRecorder::submit(Snapshot &snapshot) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    full_buffers.push_back(static_cast<int>(&snapshot - snapshots.data()));
+  }
+  full_cv.notify_one();
+}
+
+void SnapshotRecorder::record(const World &world, std::uint64_t generation) {
+  const auto start = std::chrono::steady_clock::now();
+  Snapshot &snapshot = acquire();
+  snapshot.generation = generation;
+  // pack the cells, 64 to a word, in the BitWorld layout
+  for (int y = 0; y < height; y++) {
+    const cell_t *cells = &world.state[static_cast<size_t>(y) * width];
+    word_t *row = &snapshot.words[static_cast<size_t>(y) * words_per_row];
+    for (int w = 0; w < words_per_row; w++) {
+      const int x_end = std::min(width, CELLS_PER_WORD * (w + 1));
+      word_t word = 0;
+      for (int x = CELLS_PER_WORD * w; x < x_end; x++) {
+        word |= static_cast<word_t>(cells[x] != 0) << (x - CELLS_PER_WORD * w);
+      }
+      row[w] = word;
+    }
+  }
+  submit(snapshot);
+  stats.record_seconds += seconds_since(start);
+}
+
+void SnapshotRecorder::record(const BitWorld &world, std::uint64_t generation) {
+  const auto start = std::chrono::steady_clock::now();
+  Snapshot &snapshot = acquire();
+  snapshot.generation = generation;
+  std::copy(world.words.begin(), world.words.end(), snapshot.words.begin());
+  submit(snapshot);
+  stats.record_seconds += seconds_since(start);
+}
+
+void SnapshotRecorder::writer_loop() {
+  while (true) {
+    int index;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      full_cv.wait(lock, [this] { return finishing || !full_buffers.empty(); });
+      if (full_buffers.empty()) break;
+      index = full_buffers.front();
+      full_buffers.pop_front();
+    }
+    Snapshot &snapshot = snapshots[index];
+
+    // compress, unless that does not make the snapshot smaller (e.g. random soups)
+    auto start = std::chrono::steady_clock::now();
+    const size_t words = snapshot.words.size();
+    const size_t encoded_words = rle_encode(snapshot.words.data(), words, encoded.data());
+    const bool compressed = encoded_words < words;
+    const word_t *payload = compressed ? encoded.data() : snapshot.words.data();
+    const size_t payload_bytes = (compressed ? encoded_words : words) * sizeof(word_t);
+    const CheckpointHeader header = make_checkpoint_header(width, height, rule,
+                                                           snapshot.generation, compressed,
+                                                           payload_bytes);
+    const char *header_bytes = reinterpret_cast<const char *>(&header);
+    output.insert(output.end(), header_bytes, header_bytes + sizeof(header));
+    const char *payload_chars = reinterpret_cast<const char *>(payload);
+    output.insert(output.end(), payload_chars, payload_chars + payload_bytes);
+    stats.snapshots++;
+    stats.raw_bytes += words * sizeof(word_t);
+    stats.encode_seconds += seconds_since(start);
+
+    // the buffer can be reused as soon as it is encoded into the output
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      free_buffers.push_back(index);
+    }
+    free_cv.notify_one();
+
+    if (output.size() >= SNAPSHOT_WRITE_BYTES) flush();
+  }
+  flush();
+}
+
+void SnapshotRecorder::flush() {
+  const auto start = std::chrono::steady_clock::now();
+  size_t written = 0;
+  while (written < output.size() && error.empty()) {
+    const ssize_t n = write(fd, output.data() + written, output.size() - written);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      error = "failed to write " + path + ": " + std::strerror(errno);
+      break;
+    }
+    written += static_cast<size_t>(n);
+  }
+  stats.written_bytes += written;
+  output.clear();
+  stats.write_seconds += seconds_since(start);
+}
+
+RecordingStats SnapshotRecorder::finish() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    finishing = true;
+  }
+  full_cv.notify_one();
+  writer.join();
+  close(fd);
+  finished = true;
+  if (!error.empty()) throw std::runtime_error(error);
+  return stats;
+}
+
+} // namespace ca
@@ -0,0 +1,128 @@
+// Defines a pipelined recorder for snapshots of every Nth generation. The simulation thread only
+// packs a generation into a recycled buffer; a background thread compresses it and appends it to
+// the recording with large sequential writes, so the simulation only waits for the disk when
+// every buffer is still in flight.
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bit_world.h"
+#include "rule.h"
+#include "types.h"
+
+namespace ca {
+
+// snapshot buffers in flight (the bound on the queue between the simulation and the writer)
+constexpr int SNAPSHOT_QUEUE_DEPTH = 4;
+// size of the writer's output buffer. each write to the file is about this large.
+constexpr size_t SNAPSHOT_WRITE_BYTES = 8 << 20;
+
+// what recording cost, as seen by the simulation thread and by the writer
+struct RecordingStats {
+  std::uint64_t snapshots{0};
+  // size of the snapshots as bit-packed words, and as written (headers included)
+  std::uint64_t raw_bytes{0};
+  std::uint64_t written_bytes{0};
+  // time the simulation thread spent in record(), and the part of it spent waiting for a buffer
+  double record_seconds{0};
+  double stall_seconds{0};
+  // time the writer spent compressing and writing
+  double encode_seconds{0};
+  double write_seconds{0};
+  // record_seconds as a fraction of the duration of the run (set by the benchmark)
+  double overhead{0};
+
+  std::string to_json() const {
+    std::stringstream ss;
+    ss << "{";
+    ss << "\"snapshots\": " << snapshots << ",";
+    ss << "\"raw_bytes\": " << raw_bytes << ",";
+    ss << "\"written_bytes\": " << written_bytes << ",";
+    ss << "\"record_seconds\": " << record_seconds << ",";
+    ss << "\"stall_seconds\": " << stall_seconds << ",";
+    ss << "\"encode_seconds\": " << encode_seconds << ",";
+    ss << "\"write_seconds\": " << write_seconds << ",";
+    ss << "\"overhead\": " << overhead;
+    ss << "}";
+    return ss.str();
+  }
+};
+
+// Writes a recording: checkpoints (see world_io.h) stored back to back, one per snapshot, read
+// back with load_recording. Payloads are run-length encoded when that makes them smaller.
+class SnapshotRecorder {
+public:
+  /**
+   * @brief create (or truncate) the recording and start the writer thread
+   *
+   * @param path the file to write
+   * @param width world width
+   * @param height world height
+   * @param rule stored in every snapshot's header
+   * @param queue_depth number of snapshot buffers
+   */
+  SnapshotRecorder(const std::string &path, int width, int height, Rule rule,
+                   int queue_depth = SNAPSHOT_QUEUE_DEPTH);
+  // finishes the recording, if finish() was not called
+  ~SnapshotRecorder();
+
+  SnapshotRecorder(const SnapshotRecorder &) = delete;
+  SnapshotRecorder &operator=(const SnapshotRecorder &) = delete;
+
+  // queue a snapshot of a byte-per-cell or bit-packed world (packed on the calling thread).
+  // blocks only while every buffer is in flight.
+  void record(const World &world, std::uint64_t generation);
+  void record(const BitWorld &world, std::uint64_t generation);
+
+  // wait for the queued snapshots to be written and close the file. throws std::runtime_error
+  // if writing failed.
+  RecordingStats finish();
+
+private:
+  struct Snapshot {
+    std::vector<word_t> words;
+    std::uint64_t generation{0};
+  };
+
+  // take a free buffer, waiting if there is none
+  Snapshot &acquire();
+  // hand a filled buffer to the writer
+  void submit(Snapshot &snapshot);
+  void writer_loop();
+  // write out the output buffer
+  void flush();
+
+  std::string path;
+  int width;
+  int height;
+  int words_per_row;
+  Rule rule;
+  int fd{-1};
+
+  std::vector<Snapshot> snapshots;
+  std::mutex mutex;
+  std::condition_variable free_cv;
+  std::condition_variable full_cv;
+  // indices into snapshots
+  std::deque<int> free_buffers;
+  std::deque<int> full_buffers;
+  bool finishing{false};
+  bool finished{false};
+
+  // owned by the writer thread
+  std::vector<word_t> encoded;
+  std::vector<char> output;
+  std::string error;
+
+  RecordingStats stats;
+  std::thread writer;
+};
+
+} // namespace ca
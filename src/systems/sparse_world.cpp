@@ -0,0 +1,271 @@
+// Defines an unbounded (infinite plane) engine that stores the world as sparse 64x64 chunks
+// in an open addressing hash map. Memory grows with the live area rather than with a fixed
+// world size, which suits patterns that keep growing (guns, puffers).
+#include "sparse_world.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace ca {
+
+namespace {
+constexpr int N = SPARSE_CHUNK_SIZE;
+// rows of chunks that do not exist
+const word_t EMPTY_ROWS[N] = {};
+
+// chunk coordinate of a cell coordinate (floor division, also for negative coordinates)
+static_assert(N == 64, "chunk_of assumes 64 cell chunks");
+std::int32_t chunk_of(long v) {
+  return static_cast<std::int32_t>(v >> 6);
+}
+
+std::uint64_t mix(std::uint64_t key) {
+  // splitmix64 finalizer
+  key ^= key >> 30;
+  key *= 0xbf58476d1ce4e5b9ULL;
+  key ^= key >> 27;
+  key *= 0x94d049bb133111ebULL;
+  return key ^ (key >> 31);
+}
+} // namespace
+
+SparseWorld::SparseWorld(const World &world, Rule rule) : rule(rule) {
+  if (rule.birth & 1) {
+    throw std::invalid_argument("rules with B0 cannot run on an unbounded world: " +
+                                rule.to_string());
+  }
+  rehash(64);
+  for (int y = 0; y < world.height; y++) {
+    for (int x = 0; x < world.width; x++) {
+      if (world.state[static_cast<size_t>(y) * world.width + x] == 0) continue;
+      Chunk *chunk = find_or_create(chunk_of(x), chunk_of(y));
+      chunk->rows[current][y % N] |= word_t{1} << (x % N);
+    }
+  }
+}
+
+void SparseWorld::step() {
+  // make sure every chunk that can come alive exists: a chunk with living cells on an edge or
+  // corner can spread into the neighbor across it. only the chunks that existed before this
+  // loop are checked, since the new ones are empty.
+  const size_t existing = chunks.size();
+  for (size_t i = 0; i < existing; i++) {
+    const Chunk &chunk = *chunks[i];
+    const word_t *rows = chunk.rows[current];
+    const word_t top = rows[0];
+    const word_t bottom = rows[N - 1];
+    // the columns with any living cell. bit 0 is the west edge, bit N - 1 the east edge.
+    word_t columns = 0;
+    for (int y = 0; y < N; y++) {
+      columns |= rows[y];
+    }
+    if (columns == 0) continue;
+    const std::int32_t cx = chunk.cx;
+    const std::int32_t cy = chunk.cy;
+    if (top) find_or_create(cx, cy - 1);
+    if (bottom) find_or_create(cx, cy + 1);
+    if (columns & 1) find_or_create(cx - 1, cy);
+    if (columns >> (N - 1)) find_or_create(cx + 1, cy);
+    if (top & 1) find_or_create(cx - 1, cy - 1);
+    if (top >> (N - 1)) find_or_create(cx + 1, cy - 1);
+    if (bottom & 1) find_or_create(cx - 1, cy + 1);
+    if (bottom >> (N - 1)) find_or_create(cx + 1, cy + 1);
+  }
+
+  with_rule_kernel(rule, [&](auto kernel) {
+    for (Chunk *chunk : chunks) {
+      step_chunk(*chunk, kernel);
+    }
+  });
+  current ^= 1;
+
+  // free the chunks that died. missing chunks read as empty, so this never changes the result.
+  size_t kept = 0;
+  for (Chunk *chunk : chunks) {
+    if (chunk->alive) {
+      chunks[kept++] = chunk;
+    } else {
+      erase(chunk);
+      release(chunk);
+    }
+  }
+  chunks.resize(kept);
+}
+
+template <typename Kernel>
+void SparseWorld::step_chunk(Chunk &chunk, Kernel kernel) {
+  // the 3x3 block of chunks around this one (empty rows for missing neighbors)
+  const word_t *around[3][3];
+  for (int dy = -1; dy <= 1; dy++) {
+    for (int dx = -1; dx <= 1; dx++) {
+      const Chunk *other = (dx == 0 && dy == 0) ? &chunk : find(chunk.cx + dx, chunk.cy + dy);
+      around[dy + 1][dx + 1] = other != nullptr ? other->rows[current] : EMPTY_ROWS;
+    }
+  }
+
+  // rows -1 to N of this chunk's columns, along with the same rows shifted by one cell to the
+  // east and west, with the neighboring chunks' edge bits carried in
+  word_t mid[N + 2], west[N + 2], east[N + 2];
+  for (int r = 0; r < N + 2; r++) {
+    const int band = r == 0 ? 0 : (r == N + 1 ? 2 : 1);
+    const int y = (r - 1 + N) % N;
+    const word_t c = around[band][1][y];
+    mid[r] = c;
+    west[r] = (c << 1) | (around[band][0][y] >> (N - 1));
+    east[r] = (c >> 1) | (around[band][2][y] << (N - 1));
+  }
+
+  word_t *out = chunk.rows[current ^ 1];
+  word_t any = 0;
+  for (int y = 0; y < N; y++) {
+    out[y] = kernel(west[y], mid[y], east[y], west[y + 1], mid[y + 1], east[y + 1], west[y + 2],
+                    mid[y + 2], east[y + 2]);
+    any |= out[y];
+  }
+  chunk.alive = any != 0;
+}
+
+SparseWorld::Bounds SparseWorld::bounds() const {
+  long x_min = 0, y_min = 0, x_max = -1, y_max = -1;
+  bool found = false;
+  for (const Chunk *chunk : chunks) {
+    const word_t *rows = chunk->rows[current];
+    word_t columns = 0;
+    int first_row = -1, last_row = -1;
+    for (int y = 0; y < N; y++) {
+      if (rows[y] == 0) continue;
+      columns |= rows[y];
+      if (first_row < 0) first_row = y;
+      last_row = y;
+    }
+    if (columns == 0) continue;
+    const long x0 = static_cast<long>(chunk->cx) * N + std::countr_zero(columns);
+    const long x1 = static_cast<long>(chunk->cx) * N + (N - 1 - std::countl_zero(columns));
+    const long y0 = static_cast<long>(chunk->cy) * N + first_row;
+    const long y1 = static_cast<long>(chunk->cy) * N + last_row;
+    if (!found) {
+      x_min = x0, x_max = x1, y_min = y0, y_max = y1;
+      found = true;
+    } else {
+      x_min = std::min(x_min, x0), x_max = std::max(x_max, x1);
+      y_min = std::min(y_min, y0), y_max = std::max(y_max, y1);
+    }
+  }
+  return Bounds{x_min, y_min, x_max - x_min + 1, y_max - y_min + 1};
+}
+
+World SparseWorld::to_world(long x, long y, int width, int height) const {
+  World world;
+  world.width = width;
+  world.height = height;
+  world.state.assign(static_cast<size_t>(width) * height, 0);
+  for (const Chunk *chunk : chunks) {
+    const long chunk_x = static_cast<long>(chunk->cx) * N;
+    const long chunk_y = static_cast<long>(chunk->cy) * N;
+    // overlap of the chunk and the window, in plane coordinates
+    const long x0 = std::max(chunk_x, x), x1 = std::min(chunk_x + N, x + width);
+    const long y0 = std::max(chunk_y, y), y1 = std::min(chunk_y + N, y + height);
+    for (long py = y0; py < y1; py++) {
+      const word_t row = chunk->rows[current][py - chunk_y];
+      if (row == 0) continue;
+      cell_t *dst = &world.state[static_cast<size_t>(py - y) * width];
+      for (long px = x0; px < x1; px++) {
+        dst[px - x] = (row >> (px - chunk_x)) & 1;
+      }
+    }
+  }
+  return world;
+}
+
+World SparseWorld::to_world() const {
+  Bounds b = bounds();
+  return to_world(b.x, b.y, static_cast<int>(b.width), static_cast<int>(b.height));
+}
+
+unsigned long SparseWorld::get_mem_size() const {
+  return blocks.size() * CHUNKS_PER_BLOCK * sizeof(Chunk) + table.size() * sizeof(Slot) +
+         (chunks.capacity() + free_chunks.capacity()) * sizeof(Chunk *);
+}
+
+size_t SparseWorld::slot_of(std::uint64_t key) const {
+  return mix(key) & (table.size() - 1);
+}
+
+SparseWorld::Chunk *SparseWorld::find(std::int32_t cx, std::int32_t cy) const {
+  const std::uint64_t key = key_of(cx, cy);
+  const size_t mask = table.size() - 1;
+  for (size_t i = slot_of(key);; i = (i + 1) & mask) {
+    const Slot &slot = table[i];
+    if (slot.chunk == nullptr) return nullptr;
+    if (slot.key == key) return slot.chunk;
+  }
+}
+
+SparseWorld::Chunk *SparseWorld::find_or_create(std::int32_t cx, std::int32_t cy) {
+  // keep the load factor at or below one half
+  if (2 * (chunks.size() + 1) > table.size()) rehash(table.size() * 2);
+  const std::uint64_t key = key_of(cx, cy);
+  const size_t mask = table.size() - 1;
+  size_t i = slot_of(key);
+  for (; table[i].chunk != nullptr; i = (i + 1) & mask) {
+    if (table[i].key == key) return table[i].chunk;
+  }
+  Chunk *chunk = allocate();
+  chunk->cx = cx;
+  chunk->cy = cy;
+  table[i] = Slot{key, chunk};
+  chunks.push_back(chunk);
+  return chunk;
+}
+
+void SparseWorld::erase(const Chunk *chunk) {
+  const size_t mask = table.size() - 1;
+  size_t i = slot_of(key_of(chunk->cx, chunk->cy));
+  while (table[i].chunk != chunk) i = (i + 1) & mask;
+  // backward shift deletion: pull later entries of the probe sequence into the hole,
+  // so lookups never need tombstones
+  size_t hole = i;
+  for (size_t j = (i + 1) & mask; table[j].chunk != nullptr; j = (j + 1) & mask) {
+    const size_t home = slot_of(table[j].key);
+    // move j into the hole unless its home slot lies cyclically in (hole, j]
+    const bool stays = hole <= j ? (hole < home && home <= j) : (hole < home || home <= j);
+    if (!stays) {
+      table[hole] = table[j];
+      hole = j;
+    }
+  }
+  table[hole] = Slot{0, nullptr};
+}
+
+void SparseWorld::rehash(size_t capacity) {
+  std::vector<Slot> old = std::move(table);
+  table.assign(capacity, Slot{0, nullptr});
+  const size_t mask = capacity - 1;
+  for (const Slot &slot : old) {
+    if (slot.chunk == nullptr) continue;
+    size_t i = slot_of(slot.key);
+    while (table[i].chunk != nullptr) i = (i + 1) & mask;
+    table[i] = slot;
+  }
+}
+
+SparseWorld::Chunk *SparseWorld::allocate() {
+  if (free_chunks.empty()) {
+    blocks.push_back(std::make_unique<Chunk[]>(CHUNKS_PER_BLOCK));
+    Chunk *block = blocks.back().get();
+    // hand out the block front to back
+    for (size_t i = CHUNKS_PER_BLOCK; i-- > 0;) free_chunks.push_back(&block[i]);
+  }
+  Chunk *chunk = free_chunks.back();
+  free_chunks.pop_back();
+  std::fill_n(&chunk->rows[0][0], 2 * N, word_t{0});
+  chunk->alive = false;
+  return chunk;
+}
+
+void SparseWorld::release(Chunk *chunk) {
+  free_chunks.push_back(chunk);
+}
+
+} // namespace ca
@@ -0,0 +1,98 @@
+// Defines an unbounded (infinite plane) engine that stores the world as sparse 64x64 chunks
+// in an open addressing hash map. Memory grows with the live area rather than with a fixed
+// world size, which suits patterns that keep growing (guns, puffers).
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "bit_world.h"
+#include "rule.h"
+#include "types.h"
+
+namespace ca {
+
+// chunk edge length in cells. one word per chunk row.
+constexpr int SPARSE_CHUNK_SIZE = CELLS_PER_WORD;
+
+class SparseWorld {
+public:
+  /**
+   * @brief import a world into the plane, with its top left corner at the origin
+   *
+   * @param world the initial state
+   * @param rule the rule to apply. rules with B0 are rejected (std::invalid_argument), since
+   * they would bring the whole infinite plane to life.
+   */
+  SparseWorld(const World &world, Rule rule);
+
+  // advance one generation
+  void step();
+
+  // axis aligned bounding box of the living cells. width and height are 0 if there are none.
+  struct Bounds {
+    long x{0};
+    long y{0};
+    long width{0};
+    long height{0};
+  };
+  Bounds bounds() const;
+
+  // export the window of the plane at (x, y) with the given size
+  World to_world(long x, long y, int width, int height) const;
+  // export the bounding box of the living cells (see bounds() for where it lies in the plane)
+  World to_world() const;
+
+  // number of chunks currently allocated
+  size_t chunk_count() const { return chunks.size(); }
+
+  // memory held by the chunk arena and the hash map
+  unsigned long get_mem_size() const;
+
+private:
+  // a chunk holds its rows for both the current and the next generation
+  struct Chunk {
+    word_t rows[2][SPARSE_CHUNK_SIZE];
+    std::int32_t cx;
+    std::int32_t cy;
+    bool alive;
+  };
+  // chunks are carved out of blocks of this many chunks, and recycled through a free list
+  static constexpr size_t CHUNKS_PER_BLOCK = 256;
+
+  struct Slot {
+    std::uint64_t key;
+    Chunk *chunk;  // nullptr for empty slots
+  };
+
+  static std::uint64_t key_of(std::int32_t cx, std::int32_t cy) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32) |
+           static_cast<std::uint32_t>(cy);
+  }
+
+  // hash map operations (linear probing, backward shift deletion)
+  Chunk *find(std::int32_t cx, std::int32_t cy) const;
+  // find the chunk, allocating an empty one if it does not exist yet
+  Chunk *find_or_create(std::int32_t cx, std::int32_t cy);
+  void erase(const Chunk *chunk);
+  void rehash(size_t capacity);
+  size_t slot_of(std::uint64_t key) const;
+
+  // arena operations
+  Chunk *allocate();
+  void release(Chunk *chunk);
+
+  template <typename Kernel>
+  void step_chunk(Chunk &chunk, Kernel kernel);
+
+  Rule rule;
+  // which of the two row buffers in each chunk holds the current generation
+  int current{0};
+  std::vector<Chunk *> chunks;
+  std::vector<Slot> table;
+  std::vector<std::unique_ptr<Chunk[]>> blocks;
+  std::vector<Chunk *> free_chunks;
+};
+
+} // namespace ca
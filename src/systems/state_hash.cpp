@@ -0,0 +1,106 @@
+// Defines a 64-bit digest of a world's state (a hash and the population), computed the same way
+// for every layout, so results can be validated by comparing digests instead of whole worlds.
+#include "state_hash.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <vector>
+
+namespace ca {
+
+namespace {
+std::uint64_t mix(std::uint64_t key) {
+  // splitmix64 finalizer
+  key ^= key >> 30;
+  key *= 0xbf58476d1ce4e5b9ULL;
+  key ^= key >> 27;
+  key *= 0x94d049bb133111ebULL;
+  return key ^ (key >> 31);
+}
+
+// partial digest of a band of rows: the sum of the row hashes, and the population
+struct Partial {
+  std::uint64_t hash_sum{0};
+  std::uint64_t population{0};
+};
+
+std::uint64_t row_hash(const word_t *row, int words_per_row, int y) {
+  std::uint64_t h = mix(static_cast<std::uint64_t>(y) + 0x9e3779b97f4a7c15ULL);
+  for (int w = 0; w < words_per_row; w++) {
+    h = mix(h ^ row[w]) + static_cast<std::uint64_t>(w);
+  }
+  return h;
+}
+
+// hash rows [y_begin, y_end). load_row(y, buffer) returns a pointer to the packed row.
+template <typename LoadRow>
+Partial hash_rows(int y_begin, int y_end, int words_per_row, LoadRow load_row) {
+  Partial partial;
+  std::vector<word_t> buffer(words_per_row);
+  for (int y = y_begin; y < y_end; y++) {
+    const word_t *row = load_row(y, buffer.data());
+    partial.hash_sum += row_hash(row, words_per_row, y);
+    for (int w = 0; w < words_per_row; w++) {
+      partial.population += std::popcount(row[w]);
+    }
+  }
+  return partial;
+}
+
+template <typename LoadRow>
+StateDigest digest(int width, int height, int words_per_row, ThreadPool *pool,
+                   LoadRow load_row) {
+  Partial total;
+  if (pool == nullptr || pool->size() <= 1) {
+    total = hash_rows(0, height, words_per_row, load_row);
+  } else {
+    const int num_threads = pool->size();
+    std::vector<Partial> partials(num_threads);
+    pool->run([&](int thread_index) {
+      const int y_begin = static_cast<int>(static_cast<long>(height) * thread_index / num_threads);
+      const int y_end =
+          static_cast<int>(static_cast<long>(height) * (thread_index + 1) / num_threads);
+      partials[thread_index] = hash_rows(y_begin, y_end, words_per_row, load_row);
+    });
+    for (const Partial &partial : partials) {
+      total.hash_sum += partial.hash_sum;
+      total.population += partial.population;
+    }
+  }
+  const std::uint64_t dims =
+      (static_cast<std::uint64_t>(width) << 32) | static_cast<std::uint32_t>(height);
+  return StateDigest{mix(total.hash_sum ^ mix(dims)), total.population};
+}
+} // namespace
+
+std::string StateDigest::hash_string() const {
+  char text[17];
+  std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+  return text;
+}
+
+StateDigest state_digest(const BitWorld &world, ThreadPool *pool) {
+  return digest(world.width, world.height, world.words_per_row, pool, [&](int y, word_t *) {
+    return &world.words[static_cast<size_t>(y) * world.words_per_row];
+  });
+}
+
+StateDigest state_digest(const World &world, ThreadPool *pool) {
+  const int words_per_row = (world.width + 63) / 64;
+  return digest(world.width, world.height, words_per_row, pool, [&](int y, word_t *buffer) {
+    // pack the row into the same words a BitWorld would hold
+    const cell_t *cells = &world.state[static_cast<size_t>(y) * world.width];
+    for (int w = 0; w < words_per_row; w++) {
+      const int x_end = std::min(world.width, 64 * (w + 1));
+      word_t word = 0;
+      for (int x = 64 * w; x < x_end; x++) {
+        word |= static_cast<word_t>(cells[x] != 0) << (x - 64 * w);
+      }
+      buffer[w] = word;
+    }
+    return static_cast<const word_t *>(buffer);
+  });
+}
+
+} // namespace ca
@@ -0,0 +1,46 @@
+// Defines a 64-bit digest of a world's state (a hash and the population), computed the same way
+// for every layout, so results can be validated by comparing digests instead of whole worlds.
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "bit_world.h"
+#include "thread_pool.h"
+#include "types.h"
+
+namespace ca {
+
+struct StateDigest {
+  std::uint64_t hash{0};
+  // number of living cells
+  std::uint64_t population{0};
+
+  bool operator==(const StateDigest &other) const = default;
+
+  // the hash as 16 hex digits
+  std::string hash_string() const;
+};
+
+// The hash only depends on the dimensions and the living cells: each row is packed into 64-cell
+// words (bit i of word w is cell 64w + i, padding bits zero, as in BitWorld) and hashed on its
+// own, seeded with the row index. The row hashes are summed, which does not depend on the order
+// the rows are visited in, so bands of rows can be hashed by different threads.
+
+/**
+ * @brief compute the digest of a bit-packed world
+ *
+ * @param world the world to hash. padding bits must be zero.
+ * @param pool if given, the rows are split into bands across its threads
+ */
+StateDigest state_digest(const BitWorld &world, ThreadPool *pool = nullptr);
+
+/**
+ * @brief compute the digest of a byte-per-cell world (equal to the digest of the packed world)
+ *
+ * @param world the world to hash
+ * @param pool if given, the rows are split into bands across its threads
+ */
+StateDigest state_digest(const World &world, ThreadPool *pool = nullptr);
+
+} // namespace ca
@@ -0,0 +1,58 @@
+// Defines summary statistics over repeated timing measurements, used to report benchmark
+// durations robustly (median and percentiles rather than a single run).
+#include "stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+double percentile(const std::vector<double> &sorted, double p) {
+  const double rank = p / 100.0 * (sorted.size() - 1);
+  const size_t below = static_cast<size_t>(std::floor(rank));
+  const size_t above = std::min(below + 1, sorted.size() - 1);
+  const double fraction = rank - below;
+  return sorted[below] + (sorted[above] - sorted[below]) * fraction;
+}
+
+DurationStats summarize_durations(std::vector<double> samples, double cell_updates) {
+  DurationStats stats;
+  if (samples.empty()) {
+    return stats;
+  }
+  std::sort(samples.begin(), samples.end());
+  stats.samples = static_cast<int>(samples.size());
+  double total = 0;
+  for (double s : samples) {
+    total += s;
+  }
+  stats.mean = total / samples.size();
+  double squares = 0;
+  for (double s : samples) {
+    squares += (s - stats.mean) * (s - stats.mean);
+  }
+  // sample standard deviation (0 for a single sample)
+  stats.stddev = samples.size() > 1 ? std::sqrt(squares / (samples.size() - 1)) : 0;
+  stats.median = percentile(samples, 50);
+  stats.p5 = percentile(samples, 5);
+  stats.p95 = percentile(samples, 95);
+  stats.min = samples.front();
+  stats.max = samples.back();
+  stats.cells_per_second = stats.median > 0 ? cell_updates / stats.median : 0;
+  return stats;
+}
+
+Throughput summarize_throughput(std::vector<double> batch_seconds, int num_jobs,
+                                double world_generations, double cell_updates, int job_threads) {
+  Throughput throughput;
+  throughput.job_threads = job_threads;
+  if (batch_seconds.empty()) {
+    return throughput;
+  }
+  std::sort(batch_seconds.begin(), batch_seconds.end());
+  throughput.batch_seconds = percentile(batch_seconds, 50);
+  if (throughput.batch_seconds > 0) {
+    throughput.jobs_per_second = num_jobs / throughput.batch_seconds;
+    throughput.cells_per_second = cell_updates / throughput.batch_seconds;
+    throughput.world_generations_per_second = world_generations / throughput.batch_seconds;
+  }
+  return throughput;
+}
@@ -0,0 +1,89 @@
+// Defines summary statistics over repeated timing measurements, used to report benchmark
+// durations robustly (median and percentiles rather than a single run).
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+// summary of a set of duration samples, in seconds
+struct DurationStats {
+  int samples{0};
+  double mean{0};
+  double median{0};
+  double p5{0};
+  double p95{0};
+  double stddev{0};
+  double min{0};
+  double max{0};
+  // cell updates per second at the median duration
+  double cells_per_second{0};
+
+  std::string to_json() const {
+    std::stringstream ss;
+    ss << "{";
+    ss << "\"samples\": " << samples << ",";
+    ss << "\"mean\": " << mean << ",";
+    ss << "\"median\": " << median << ",";
+    ss << "\"p5\": " << p5 << ",";
+    ss << "\"p95\": " << p95 << ",";
+    ss << "\"stddev\": " << stddev << ",";
+    ss << "\"min\": " << min << ",";
+    ss << "\"max\": " << max << ",";
+    ss << "\"cells_per_second\": " << cells_per_second;
+    ss << "}";
+    return ss.str();
+  }
+};
+
+// aggregate throughput of a batch of jobs, as opposed to the latency of each job
+struct Throughput {
+  // number of jobs run at once (1 when they run one after another)
+  int job_threads{1};
+  // median wall clock time to run the whole batch once
+  double batch_seconds{0};
+  double jobs_per_second{0};
+  double cells_per_second{0};
+  // generations advanced per second, summed over the worlds of the batch
+  double world_generations_per_second{0};
+
+  std::string to_json() const {
+    std::stringstream ss;
+    ss << "{";
+    ss << "\"job_threads\": " << job_threads << ",";
+    ss << "\"batch_seconds\": " << batch_seconds << ",";
+    ss << "\"jobs_per_second\": " << jobs_per_second << ",";
+    ss << "\"cells_per_second\": " << cells_per_second << ",";
+    ss << "\"world_generations_per_second\": " << world_generations_per_second;
+    ss << "}";
+    return ss.str();
+  }
+};
+
+/**
+ * @brief percentile of a sorted set of samples, interpolating linearly between neighbors
+ *
+ * @param sorted the samples, in ascending order (must not be empty)
+ * @param p the percentile, from 0 to 100
+ */
+double percentile(const std::vector<double> &sorted, double p);
+
+/**
+ * @brief summarize duration samples
+ *
+ * @param samples durations in seconds
+ * @param cell_updates number of cell updates performed by one sample (cells * generations)
+ */
+DurationStats summarize_durations(std::vector<double> samples, double cell_updates);
+
+/**
+ * @brief summarize the wall clock times of repeated runs of a batch of jobs
+ *
+ * @param batch_seconds wall clock time of each run of the batch
+ * @param num_jobs number of jobs in the batch
+ * @param world_generations generations performed by the whole batch (summed over its jobs)
+ * @param cell_updates cell updates performed by the whole batch
+ * @param job_threads number of jobs run at once
+ */
+Throughput summarize_throughput(std::vector<double> batch_seconds, int num_jobs,
+                                double world_generations, double cell_updates, int job_threads);
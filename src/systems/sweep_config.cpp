@@ -0,0 +1,351 @@
+// Defines parameter sweeps that are configured at runtime (from the command line or a config
+// file) rather than hard-coded, and runs them.
+#include "sweep_config.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "autotune.h"
+
+namespace {
+std::string trim(const std::string &s) {
+  const char *space = " \t\r\n";
+  size_t begin = s.find_first_not_of(space);
+  if (begin == std::string::npos) return "";
+  return s.substr(begin, s.find_last_not_of(space) - begin + 1);
+}
+
+// split "key=value" into its halves
+std::pair<std::string, std::string> split_assignment(const std::string &argument) {
+  size_t eq = argument.find('=');
+  if (eq == std::string::npos) {
+    throw std::invalid_argument("expected <parameter>=<value>, got '" + argument + "'");
+  }
+  return {trim(argument.substr(0, eq)), trim(argument.substr(eq + 1))};
+}
+
+std::vector<std::string> split_list(const std::string &list) {
+  std::vector<std::string> items;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    item = trim(item);
+    if (!item.empty()) items.push_back(item);
+  }
+  return items;
+}
+
+long parse_long(const std::string &parameter, const std::string &value) {
+  size_t used = 0;
+  long result = 0;
+  try {
+    result = std::stol(value, &used);
+  } catch (const std::exception &) {
+    used = 0;
+  }
+  if (used == 0 || used != value.size()) {
+    throw std::invalid_argument("invalid value '" + value + "' for " + parameter);
+  }
+  return result;
+}
+
+double parse_double(const std::string &parameter, const std::string &value) {
+  size_t used = 0;
+  double result = 0;
+  try {
+    result = std::stod(value, &used);
+  } catch (const std::exception &) {
+    used = 0;
+  }
+  if (used == 0 || used != value.size()) {
+    throw std::invalid_argument("invalid value '" + value + "' for " + parameter);
+  }
+  return result;
+}
+
+int parse_int(const std::string &parameter, const std::string &value) {
+  return static_cast<int>(parse_long(parameter, value));
+}
+
+bool parse_bool(const std::string &parameter, const std::string &value) {
+  if (value == "true" || value == "1") return true;
+  if (value == "false" || value == "0") return false;
+  throw std::invalid_argument("invalid value '" + value + "' for " + parameter);
+}
+
+void print_usage(const char *program) {
+  std::cout << "usage: " << program << " [options] [initial_state_file]\n"
+            << "  --sweep <parameter>=<values>  start a sweep (values: start:stop:step,\n"
+            << "                                start:stop:x<factor> or a,b,c)\n"
+            << "  --set <parameter>=<value>     set a parameter for the current sweep (before\n"
+            << "                                any --sweep: for every sweep, including the\n"
+            << "                                default sweeps)\n"
+            << "  --benchmarks <name>,...       select benchmarks by name\n"
+            << "  --output <file>               JSON file for the current sweep\n"
+            << "  --config <file>               read the same directives from a file\n"
+            << "  --help                        show this message\n"
+            << "benchmarks:";
+  for (const auto &name : benchmark_names()) {
+    std::cout << " " << name;
+  }
+  std::cout << "\nwithout any sweeps, the default sweeps are run (or a single run of the\n"
+            << "default benchmarks, if an initial state file is given)." << std::endl;
+}
+} // namespace
+
+void set_param(BenchmarkParams &params, const std::string &parameter, const std::string &value) {
+  if (parameter == "width_height") {
+    params.width_height = parse_int(parameter, value);
+  } else if (parameter == "num_jobs") {
+    params.num_jobs = parse_int(parameter, value);
+  } else if (parameter == "iterations") {
+    params.iterations = parse_int(parameter, value);
+  } else if (parameter == "seed") {
+    params.seed = static_cast<unsigned long>(parse_long(parameter, value));
+  } else if (parameter == "warmup_runs") {
+    params.warmup_runs = parse_int(parameter, value);
+  } else if (parameter == "repetitions") {
+    params.repetitions = parse_int(parameter, value);
+  } else if (parameter == "benchmarks") {
+    params.benchmarks = split_list(value);
+    // fail on typos now, rather than in the middle of a sweep
+    for (const auto &name : params.benchmarks) {
+      bool known = false;
+      for (const auto &n : benchmark_names()) {
+        known |= n == name;
+      }
+      if (!known) throw std::invalid_argument("unknown benchmark '" + name + "'");
+    }
+  } else if (parameter == "num_threads") {
+    params.num_threads = parse_int(parameter, value);
+  } else if (parameter == "pin_threads") {
+    params.pin_threads = parse_bool(parameter, value);
+  } else if (parameter == "job_threads") {
+    params.job_threads = parse_int(parameter, value);
+  } else if (parameter == "tile_size") {
+    params.tile_size = parse_int(parameter, value);
+  } else if (parameter == "tile_generations") {
+    params.tile_generations = parse_int(parameter, value);
+    if (params.tile_generations <= 0) {
+      throw std::invalid_argument("tile_generations must be positive, got '" + value + "'");
+    }
+  } else if (parameter == "hashlife_memory_mb") {
+    params.hashlife_memory_mb = parse_int(parameter, value);
+  } else if (parameter == "active_tile_size") {
+    params.active_tile_size = parse_int(parameter, value);
+  } else if (parameter == "live_cell_density") {
+    params.live_cell_density = parse_double(parameter, value);
+    if (!(params.live_cell_density >= 0 && params.live_cell_density <= 1)) {
+      throw std::invalid_argument("live_cell_density must be between 0 and 1, got '" + value +
+                                  "'");
+    }
+  } else if (parameter == "domains_x") {
+    params.domains_x = parse_int(parameter, value);
+  } else if (parameter == "domains_y") {
+    params.domains_y = parse_int(parameter, value);
+  } else if (parameter == "rule") {
+    params.rule = ca::parse_rule(value);
+  } else if (parameter == "initial_state_file") {
+    params.initial_state_file = value;
+  } else if (parameter == "soup_size") {
+    params.soup_size = parse_int(parameter, value);
+  } else if (parameter == "density") {
+    params.density = parse_double(parameter, value);
+    if (!(params.density >= 0 && params.density <= 1)) {
+      throw std::invalid_argument("density must be between 0 and 1, got '" + value + "'");
+    }
+  } else if (parameter == "perf_counters") {
+    params.perf_counters = parse_bool(parameter, value);
+  } else if (parameter == "check_golden") {
+    params.check_golden = parse_bool(parameter, value);
+  } else if (parameter == "trace_every") {
+    params.trace_every = parse_int(parameter, value);
+  } else if (parameter == "trace_file") {
+    params.trace_file = value;
+  } else if (parameter == "record_every") {
+    params.record_every = parse_int(parameter, value);
+  } else if (parameter == "record_file") {
+    params.record_file = value;
+  } else if (parameter == "render_every") {
+    params.render_every = parse_int(parameter, value);
+  } else if (parameter == "render_size") {
+    params.render_size = parse_int(parameter, value);
+    if (params.render_size <= 0) {
+      throw std::invalid_argument("render_size must be positive, got '" + value + "'");
+    }
+  } else if (parameter == "render_file") {
+    params.render_file = value;
+  } else if (parameter == "cycle_mode") {
+    params.cycle_mode = ca::parse_cycle_mode(value);
+  } else if (parameter == "autotune") {
+    params.autotune = parse_bool(parameter, value);
+  } else if (parameter == "tune_iterations") {
+    params.tune_iterations = parse_int(parameter, value);
+  } else if (parameter == "tuning_cache") {
+    params.tuning_cache = value;
+  } else {
+    throw std::invalid_argument("unknown parameter '" + parameter + "'");
+  }
+}
+
+std::vector<std::string> expand_values(const std::string &spec) {
+  if (spec.find(':') == std::string::npos) {
+    std::vector<std::string> values = split_list(spec);
+    if (values.empty()) throw std::invalid_argument("empty value list");
+    return values;
+  }
+
+  // start:stop:step
+  std::vector<std::string> parts;
+  std::stringstream ss(spec);
+  std::string part;
+  while (std::getline(ss, part, ':')) {
+    parts.push_back(trim(part));
+  }
+  if (parts.size() != 3) {
+    throw std::invalid_argument("expected start:stop:step, got '" + spec + "'");
+  }
+  const long start = parse_long("range start", parts[0]);
+  const long stop = parse_long("range stop", parts[1]);
+  const bool multiply = !parts[2].empty() && (parts[2][0] == 'x' || parts[2][0] == '*');
+  const long step = parse_long("range step", multiply ? parts[2].substr(1) : parts[2]);
+  if (multiply ? step < 2 || start <= 0 : step <= 0) {
+    throw std::invalid_argument("range '" + spec + "' does not advance");
+  }
+
+  std::vector<std::string> values;
+  for (long v = start; v <= stop; v = multiply ? v * step : v + step) {
+    values.push_back(std::to_string(v));
+  }
+  return values;
+}
+
+void SweepPlan::apply(const std::string &directive, const std::string &argument) {
+  if (directive == "sweep") {
+    auto [parameter, spec] = split_assignment(argument);
+    SweepConfig sweep{parameter, expand_values(spec), defaults, "change_" + parameter + ".json"};
+    // check the parameter name (and the values) up front, rather than in the middle of a run
+    for (const auto &value : sweep.values) {
+      BenchmarkParams check = defaults;
+      set_param(check, parameter, value);
+    }
+    sweeps.push_back(std::move(sweep));
+  } else if (directive == "set" || directive == "benchmarks") {
+    auto [parameter, value] =
+        directive == "set" ? split_assignment(argument) : std::make_pair(directive, argument);
+    if (sweeps.empty()) {
+      set_param(defaults, parameter, value);
+      default_settings.emplace_back(parameter, value);
+    } else {
+      set_param(sweeps.back().params, parameter, value);
+    }
+  } else if (directive == "output") {
+    if (sweeps.empty()) throw std::invalid_argument("output given before any sweep");
+    sweeps.back().output = argument;
+  } else {
+    throw std::invalid_argument("unknown directive '" + directive + "'");
+  }
+}
+
+void SweepPlan::read_config(std::istream &in) {
+  std::string line;
+  int line_number = 0;
+  while (std::getline(in, line)) {
+    line_number++;
+    line = trim(line.substr(0, line.find('#')));
+    if (line.empty()) continue;
+    size_t space = line.find_first_of(" \t");
+    std::string directive = line.substr(0, space);
+    std::string argument = space == std::string::npos ? "" : trim(line.substr(space));
+    try {
+      apply(directive, argument);
+    } catch (const std::invalid_argument &e) {
+      throw std::invalid_argument("line " + std::to_string(line_number) + ": " + e.what());
+    }
+  }
+}
+
+void SweepPlan::read_config_file(const std::string &path) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open file: " + path);
+  }
+  read_config(file);
+}
+
+void SweepPlan::set_everywhere(const std::string &parameter, const std::string &value) {
+  set_param(defaults, parameter, value);
+  for (auto &sweep : sweeps) {
+    set_param(sweep.params, parameter, value);
+  }
+}
+
+void SweepPlan::reapply_default_settings() {
+  for (const auto &[parameter, value] : default_settings) {
+    for (auto &sweep : sweeps) {
+      set_param(sweep.params, parameter, value);
+    }
+  }
+}
+
+SweepPlan parse_command_line(int argc, char *argv[], bool &show_help) {
+  SweepPlan plan;
+  std::string initial_state_file;
+  show_help = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      print_usage(argv[0]);
+      show_help = true;
+      return plan;
+    }
+    if (arg.rfind("--", 0) != 0) {
+      initial_state_file = arg;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      throw std::invalid_argument("missing argument for " + arg);
+    }
+    std::string value = argv[++i];
+    if (arg == "--config") {
+      plan.read_config_file(value);
+    } else {
+      plan.apply(arg.substr(2), value);
+    }
+  }
+  if (!initial_state_file.empty()) {
+    plan.set_everywhere("initial_state_file", initial_state_file);
+  }
+  return plan;
+}
+
+int run_sweep(const SweepConfig &sweep) {
+  std::cout << "Sweeping " << sweep.parameter << " over " << sweep.values.size() << " values..."
+            << std::endl;
+  std::vector<ParameterBenchmarkSet> benchmark_sets;
+  int validation_failures = 0;
+  for (const auto &value : sweep.values) {
+    // set up the parameters for the benchmark
+    BenchmarkParams params = sweep.params;
+    set_param(params, sweep.parameter, value);
+    if (!params.trace_file.empty() && sweep.parameter != "trace_file") {
+      // one trace file per value, e.g. trace.csv becomes trace_width_height_1024.csv
+      params.trace_file = path_with_suffix(params.trace_file, "_" + sweep.parameter + "_" + value);
+    }
+    if (params.record_every > 0 && sweep.parameter != "record_file") {
+      params.record_file =
+          path_with_suffix(params.record_file, "_" + sweep.parameter + "_" + value);
+    }
+    if (!params.render_file.empty() && sweep.parameter != "render_file") {
+      params.render_file =
+          path_with_suffix(params.render_file, "_" + sweep.parameter + "_" + value);
+    }
+    // run the benchmarks for this parameter set (or tune the engines for it)
+    benchmark_sets.push_back(params.autotune ? autotune(params) : run_benchmarks(params));
+    validation_failures += benchmark_sets.back().validation_failures;
+  }
+  ParameterSweep(sweep.parameter, std::move(benchmark_sets)).write_to_json(sweep.output);
+  return validation_failures;
+}
@@ -0,0 +1,76 @@
+// Defines parameter sweeps that are configured at runtime (from the command line or a config
+// file) rather than hard-coded, and runs them.
+//
+// Both sources use the same directives, applied in order:
+//   sweep <parameter>=<values>   start a new sweep over a parameter
+//   set <parameter>=<value>      set a parameter for the current sweep (or for all later sweeps,
+//                                if no sweep has been started yet)
+//   benchmarks <name>,<name>...  shorthand for set benchmarks=...
+//   output <file>                JSON file the current sweep is written to
+// values are either a range, start:stop:step (step "x2" multiplies instead of adding), or a
+// comma separated list. e.g. "sweep iterations=1024:1048576:x2" or "sweep rule=B3/S23,B36/S23".
+// On the command line the directives are written as options (--sweep, --set, --benchmarks,
+// --output), and --config reads a file with one directive per line ('#' starts a comment).
+#pragma once
+
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "run_benchmarks.h"
+
+// one parameter sweep: run_benchmarks is called once per value
+struct SweepConfig {
+  // name of the swept parameter (a BenchmarkParams field)
+  std::string parameter;
+  std::vector<std::string> values;
+  // every other parameter
+  BenchmarkParams params;
+  // JSON file to write. defaults to change_<parameter>.json
+  std::string output;
+};
+
+// a list of sweeps, along with the parameters new sweeps start from
+struct SweepPlan {
+  BenchmarkParams defaults;
+  std::vector<SweepConfig> sweeps;
+  // the "set" directives applied to the defaults (before any sweep), in order
+  std::vector<std::pair<std::string, std::string>> default_settings;
+
+  // apply one directive ("sweep", "set", "benchmarks" or "output"). throws std::invalid_argument.
+  void apply(const std::string &directive, const std::string &argument);
+  // apply the directives in a config file or stream, one per line
+  void read_config(std::istream &in);
+  void read_config_file(const std::string &path);
+  // set a parameter on the defaults and on every sweep
+  void set_everywhere(const std::string &parameter, const std::string &value);
+  // apply default_settings again on top of every sweep, so that they win over the settings of
+  // sweeps read afterwards (e.g. the default sweeps, when none were given on the command line)
+  void reapply_default_settings();
+};
+
+/**
+ * @brief set a BenchmarkParams field from its name and a string value
+ *
+ * @param params the parameters to modify
+ * @param parameter field name, e.g. "width_height" or "rule"
+ * @param value the new value, e.g. "1024" or "B36/S23"
+ */
+void set_param(BenchmarkParams &params, const std::string &parameter, const std::string &value);
+
+// expand "start:stop:step", "start:stop:xfactor" or "a,b,c" into the list of values
+std::vector<std::string> expand_values(const std::string &spec);
+
+/**
+ * @brief parse the command line into a sweep plan
+ *
+ * @param argc argument count
+ * @param argv arguments. a positional argument is an initial state file for every sweep.
+ * @param show_help set to true if --help was passed (usage has been printed)
+ */
+SweepPlan parse_command_line(int argc, char *argv[], bool &show_help);
+
+// run every value of a sweep and write the results. returns the number of validation failures
+// (see ParameterBenchmarkSet::validation_failures) over all values.
+int run_sweep(const SweepConfig &sweep);
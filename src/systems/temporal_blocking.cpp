@@ -0,0 +1,129 @@
+// Defines a temporally blocked (multi-generation tiled) CPU update for bit-packed worlds.
+// Each tile is copied into a small cache-resident buffer together with a ghost zone that is as
+// wide as the number of generations it is advanced by, so the whole world is only streamed
+// through memory once per block of generations instead of once per generation.
+#include "temporal_blocking.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace ca {
+
+namespace {
+/**
+ * @brief update one row of a local tile buffer, treating everything outside the buffer as dead
+ *
+ * the cells near the buffer edges come out wrong, but the ghost zone is wide enough that
+ * those errors never reach the tile interior within one block of generations.
+ */
+template <typename Kernel>
+void update_row_open(const word_t *up, const word_t *mid, const word_t *down, word_t *out,
+                     int words, Kernel kernel) {
+  auto west = [](const word_t *row, int i) { return (row[i] << 1) | (i > 0 ? row[i - 1] >> 63 : 0); };
+  auto east = [words](const word_t *row, int i) {
+    return (row[i] >> 1) | (i + 1 < words ? row[i + 1] << 63 : 0);
+  };
+  // edge words (the only ones that need the bounds checks)
+  out[0] = kernel(west(up, 0), up[0], east(up, 0), west(mid, 0), mid[0], east(mid, 0),
+                  west(down, 0), down[0], east(down, 0));
+  if (words > 1) {
+    const int i = words - 1;
+    out[i] = kernel(west(up, i), up[i], east(up, i), west(mid, i), mid[i], east(mid, i),
+                    west(down, i), down[i], east(down, i));
+  }
+  // interior words
+  for (int i = 1; i < words - 1; i++) {
+    out[i] = kernel((up[i] << 1) | (up[i - 1] >> 63), up[i], (up[i] >> 1) | (up[i + 1] << 63),
+                    (mid[i] << 1) | (mid[i - 1] >> 63), mid[i], (mid[i] >> 1) | (mid[i + 1] << 63),
+                    (down[i] << 1) | (down[i - 1] >> 63), down[i],
+                    (down[i] >> 1) | (down[i + 1] << 63));
+  }
+}
+
+// the tiled update, for one rule kernel
+template <typename Kernel>
+void update_blocked(const BitWorld &read, BitWorld &write, int generations, int tile_size,
+                    Kernel kernel) {
+  const int k = generations;
+  // the ghost zone must be at least k cells wide on every side
+  const int ghost_words = (k + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+  const int tile_rows = std::max(1, tile_size);
+  const int tile_words = std::max(1, (tile_size + CELLS_PER_WORD - 1) / CELLS_PER_WORD);
+  const int wpr = read.words_per_row;
+  const word_t last_mask = read.last_word_mask();
+  const bool word_aligned = read.width % CELLS_PER_WORD == 0;
+
+  // two ping-pong buffers, sized for a full tile plus its ghost zone
+  const size_t max_local_words =
+      static_cast<size_t>(tile_rows + 2 * k) * (tile_words + 2 * ghost_words);
+  std::vector<word_t> buffer_a(max_local_words);
+  std::vector<word_t> buffer_b(max_local_words);
+
+  for (int ty = 0; ty < read.height; ty += tile_rows) {
+    const int rows = std::min(tile_rows, read.height - ty);
+    const int local_rows = rows + 2 * k;
+    for (int tw = 0; tw < wpr; tw += tile_words) {
+      const int words = std::min(tile_words, wpr - tw);
+      const int local_words = words + 2 * ghost_words;
+      word_t *cur = buffer_a.data();
+      word_t *next = buffer_b.data();
+
+      // gather the tile and its ghost zone. load_word wraps around the torus, so the buffer
+      // holds an "unrolled" copy of the world even where the tile runs past the east edge.
+      // when rows are a whole number of words, wrapping is just indexing modulo the row length.
+      for (int r = 0; r < local_rows; r++) {
+        word_t *dst = &cur[static_cast<size_t>(r) * local_words];
+        if (word_aligned) {
+          const int y = ((ty + r - k) % read.height + read.height) % read.height;
+          const word_t *src = &read.words[static_cast<size_t>(y) * wpr];
+          int w = ((tw - ghost_words) % wpr + wpr) % wpr;
+          for (int i = 0; i < local_words; i++) {
+            dst[i] = src[w];
+            if (++w == wpr) {
+              w = 0;
+            }
+          }
+        } else {
+          for (int i = 0; i < local_words; i++) {
+            dst[i] = read.load_word(static_cast<long>(tw + i - ghost_words) * CELLS_PER_WORD,
+                                    ty + r - k);
+          }
+        }
+      }
+
+      // advance the tile k generations. the valid region shrinks by one row per generation,
+      // so only the rows that can still influence the tile interior are recomputed.
+      for (int s = 1; s <= k; s++) {
+        for (int r = s; r < local_rows - s; r++) {
+          update_row_open(&cur[static_cast<size_t>(r - 1) * local_words],
+                          &cur[static_cast<size_t>(r) * local_words],
+                          &cur[static_cast<size_t>(r + 1) * local_words],
+                          &next[static_cast<size_t>(r) * local_words], local_words, kernel);
+        }
+        std::swap(cur, next);
+      }
+
+      // scatter the interior back to the world
+      for (int r = 0; r < rows; r++) {
+        const word_t *src = &cur[static_cast<size_t>(r + k) * local_words + ghost_words];
+        word_t *dst = &write.words[static_cast<size_t>(ty + r) * wpr + tw];
+        std::copy(src, src + words, dst);
+        if (tw + words == wpr) {
+          // keep the padding bits past the east edge clear
+          dst[words - 1] &= last_mask;
+        }
+      }
+    }
+  }
+}
+} // namespace
+
+void update_bit_state_blocked(const BitWorld &read, BitWorld &write, int generations,
+                              int tile_size, Rule rule) {
+  // pick the rule's kernel once, outside the loops
+  with_rule_kernel(rule, [&](auto kernel) {
+    update_blocked(read, write, generations, tile_size, kernel);
+  });
+}
+
+} // namespace ca
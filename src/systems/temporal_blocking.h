@@ -0,0 +1,30 @@
+// Defines a temporally blocked (multi-generation tiled) CPU update for bit-packed worlds.
+// Each tile is copied into a small cache-resident buffer together with a ghost zone that is as
+// wide as the number of generations it is advanced by, so the whole world is only streamed
+// through memory once per block of generations instead of once per generation.
+#pragma once
+
+#include "bit_world.h"
+
+namespace ca {
+
+// default number of generations each tile is advanced by before being written back
+constexpr int TILE_GENERATIONS = 8;
+// default tile edge length in cells (rounded up to a whole number of words horizontally)
+constexpr int TILE_SIZE = 512;
+
+/**
+ * @brief advance a bit-packed world by several generations using overlapped temporal tiling
+ *
+ * the result is bit-identical to calling update_bit_state `generations` times.
+ *
+ * @param read the current state of the world
+ * @param write receives the state `generations` generations later
+ * @param generations number of generations to advance. must be at least 1.
+ * @param tile_size tile edge length in cells
+ * @param rule the rule to apply
+ */
+void update_bit_state_blocked(const BitWorld &read, BitWorld &write, int generations,
+                              int tile_size, Rule rule);
+
+} // namespace ca
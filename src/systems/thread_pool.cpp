@@ -0,0 +1,97 @@
+// Defines a persistent thread pool and a spinning barrier, used by the multithreaded CPU benchmarks.
+// The pool's threads are created once and reused for every job, so no threads are spawned
+// per job or per generation.
+#include "thread_pool.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace ca {
+
+void SpinBarrier::wait() {
+  const unsigned my_phase = phase.load(std::memory_order_acquire);
+  if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == num_threads) {
+    // last thread to arrive resets the count and releases everyone else
+    arrived.store(0, std::memory_order_relaxed);
+    phase.fetch_add(1, std::memory_order_release);
+    return;
+  }
+  // spin for a short while, then start yielding so oversubscribed machines still make progress
+  int spins = 0;
+  while (phase.load(std::memory_order_acquire) == my_phase) {
+    if (++spins > 1024) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+int hardware_threads() {
+  unsigned n = std::thread::hardware_concurrency();
+  return n == 0 ? 1 : static_cast<int>(n);
+}
+
+ThreadPool::ThreadPool(int num_threads, bool pin_threads) {
+  if (num_threads <= 0) {
+    num_threads = hardware_threads();
+  }
+  const int cores = hardware_threads();
+  workers.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    workers.emplace_back(&ThreadPool::worker_loop, this, i);
+    if (pin_threads) {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(i % cores, &cpus);
+      // pinning is best-effort; an unpinned worker still produces correct results
+      pthread_setaffinity_np(workers.back().native_handle(), sizeof(cpus), &cpus);
+    }
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  start_cv.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::run(const std::function<void(int)> &task) {
+  std::unique_lock<std::mutex> lock(mutex);
+  this->task = &task;
+  remaining = size();
+  ++task_generation;
+  start_cv.notify_all();
+  done_cv.wait(lock, [this] { return remaining == 0; });
+  this->task = nullptr;
+}
+
+void ThreadPool::worker_loop(int index) {
+  unsigned long seen_generation = 0;
+  while (true) {
+    const std::function<void(int)> *current;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      start_cv.wait(lock, [&] { return stopping || task_generation != seen_generation; });
+      if (stopping) {
+        return;
+      }
+      seen_generation = task_generation;
+      current = task;
+    }
+
+    (*current)(index);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--remaining == 0) {
+        done_cv.notify_one();
+      }
+    }
+  }
+}
+
+} // namespace ca
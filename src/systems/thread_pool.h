@@ -0,0 +1,65 @@
+// Defines a persistent thread pool and a spinning barrier, used by the multithreaded CPU benchmarks.
+// The pool's threads are created once and reused for every job, so no threads are spawned
+// per job or per generation.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ca {
+
+// Sense-reversing barrier. Threads spin briefly and then yield, which is much cheaper than
+// a mutex/condition variable pair when generations are short.
+class SpinBarrier {
+public:
+  explicit SpinBarrier(int num_threads) : num_threads(num_threads) {}
+
+  // block until all num_threads threads have called wait()
+  void wait();
+
+private:
+  const int num_threads;
+  std::atomic<int> arrived{0};
+  std::atomic<unsigned> phase{0};
+};
+
+class ThreadPool {
+public:
+  /**
+   * @brief start the worker threads
+   *
+   * @param num_threads number of worker threads. 0 means one per hardware thread.
+   * @param pin_threads if true, worker i is pinned to core i (modulo the number of cores)
+   */
+  ThreadPool(int num_threads, bool pin_threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  int size() const { return static_cast<int>(workers.size()); }
+
+  // run task(thread_index) once on every worker, and block until all of them return
+  void run(const std::function<void(int)> &task);
+
+private:
+  void worker_loop(int index);
+
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable start_cv;
+  std::condition_variable done_cv;
+  const std::function<void(int)> *task{nullptr};
+  unsigned long task_generation{0};
+  int remaining{0};
+  bool stopping{false};
+};
+
+// number of hardware threads, never less than 1
+int hardware_threads();
+
+} // namespace ca
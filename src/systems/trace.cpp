@@ -0,0 +1,116 @@
+// Defines optional per-generation timing traces, for looking at frame-time jitter rather than
+// the total duration of a run, along with their summary and export as CSV or binary files.
+#include "trace.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "stats.h"
+
+std::vector<double> GenerationTrace::latencies() const {
+  std::vector<double> result;
+  result.reserve(generations.size());
+  std::uint64_t previous_generation = 0;
+  std::int64_t previous_ns = 0;
+  for (size_t i = 0; i < generations.size(); i++) {
+    const std::uint64_t count = generations[i] - previous_generation;
+    if (count > 0) {
+      result.push_back((nanoseconds[i] - previous_ns) * 1e-9 / count);
+    }
+    previous_generation = generations[i];
+    previous_ns = nanoseconds[i];
+  }
+  return result;
+}
+
+std::string GenerationTrace::summary_json() const {
+  std::vector<double> sorted = latencies();
+  std::sort(sorted.begin(), sorted.end());
+  std::stringstream ss;
+  ss << std::defaultfloat << std::setprecision(6);
+  ss << "{";
+  ss << "\"every\": " << every << ",";
+  ss << "\"samples\": " << sorted.size();
+  if (!sorted.empty()) {
+    double total = 0;
+    for (double s : sorted) {
+      total += s;
+    }
+    ss << ",\"min\": " << sorted.front();
+    ss << ",\"mean\": " << total / sorted.size();
+    ss << ",\"median\": " << percentile(sorted, 50);
+    ss << ",\"p99\": " << percentile(sorted, 99);
+    ss << ",\"max\": " << sorted.back();
+  }
+  ss << "}";
+  return ss.str();
+}
+
+GenerationTracer::GenerationTracer(int every, long iterations)
+    : every(every), iterations(iterations), next(every) {
+  trace.every = every;
+  if (every > 0) {
+    // reserve up front, so recording never allocates
+    const size_t samples = static_cast<size_t>(iterations / every) + 2;
+    trace.generations.reserve(samples);
+    trace.nanoseconds.reserve(samples);
+  }
+}
+
+namespace {
+template <typename T>
+void write_raw(std::ofstream &file, T value) {
+  file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+} // namespace
+
+void write_traces(const std::string &path, const std::vector<TraceSource> &sources) {
+  const bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+  std::ofstream file(path, csv ? std::ios::out : std::ios::out | std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open file: " + path);
+  }
+
+  if (csv) {
+    file << "benchmark,job,generation,nanoseconds\n";
+    for (const auto &source : sources) {
+      const GenerationTrace &trace = *source.trace;
+      for (size_t i = 0; i < trace.generations.size(); i++) {
+        file << source.benchmark << "," << source.job << "," << trace.generations[i] << ","
+             << trace.nanoseconds[i] << "\n";
+      }
+    }
+    return;
+  }
+
+  // benchmark names are stored once, and referenced by index from the records
+  std::vector<std::string> names;
+  std::uint64_t records = 0;
+  for (const auto &source : sources) {
+    if (std::find(names.begin(), names.end(), source.benchmark) == names.end()) {
+      names.push_back(source.benchmark);
+    }
+    records += source.trace->generations.size();
+  }
+  file.write("CATRACE\0", 8);
+  write_raw<std::uint32_t>(file, 1);
+  write_raw<std::uint32_t>(file, static_cast<std::uint32_t>(names.size()));
+  for (const auto &name : names) {
+    write_raw<std::uint32_t>(file, static_cast<std::uint32_t>(name.size()));
+    file.write(name.data(), name.size());
+  }
+  write_raw<std::uint64_t>(file, records);
+  for (const auto &source : sources) {
+    const auto index = std::find(names.begin(), names.end(), source.benchmark) - names.begin();
+    const GenerationTrace &trace = *source.trace;
+    for (size_t i = 0; i < trace.generations.size(); i++) {
+      write_raw<std::uint32_t>(file, static_cast<std::uint32_t>(index));
+      write_raw<std::uint32_t>(file, static_cast<std::uint32_t>(source.job));
+      write_raw<std::uint64_t>(file, trace.generations[i]);
+      write_raw<std::int64_t>(file, trace.nanoseconds[i]);
+    }
+  }
+}
@@ -0,0 +1,81 @@
+// Defines optional per-generation timing traces, for looking at frame-time jitter rather than
+// the total duration of a run, along with their summary and export as CSV or binary files.
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// timestamps taken during one run, every `every` generations
+struct GenerationTrace {
+  int every{0};
+  // number of generations completed at each timestamp
+  std::vector<std::uint64_t> generations{};
+  // time since the start of the run, in nanoseconds
+  std::vector<std::int64_t> nanoseconds{};
+
+  bool empty() const { return generations.empty(); }
+
+  // seconds per generation over each interval between timestamps
+  std::vector<double> latencies() const;
+
+  // min/mean/median/p99/max of the per-generation latencies
+  std::string summary_json() const;
+};
+
+// Records a GenerationTrace from inside an engine's generation loop. record() is cheap (a clock
+// read and two stores into reserved vectors) when a timestamp is due, and a compare otherwise.
+class GenerationTracer {
+public:
+  /**
+   * @brief prepare a trace
+   *
+   * @param every take a timestamp whenever at least this many generations completed since the
+   * last one. 0 disables tracing.
+   * @param iterations total generations of the run (the last one is always recorded)
+   */
+  GenerationTracer(int every, long iterations);
+
+  // mark the start of the run
+  void start() { start_time = std::chrono::steady_clock::now(); }
+
+  // call after each generation (or block of generations) with the number completed so far
+  void record(long generation) {
+    if (every <= 0 || (generation < next && generation != iterations)) return;
+    const auto now = std::chrono::steady_clock::now();
+    trace.generations.push_back(static_cast<std::uint64_t>(generation));
+    trace.nanoseconds.push_back(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_time).count());
+    next = generation + every;
+  }
+
+  GenerationTrace finish() { return std::move(trace); }
+
+private:
+  int every;
+  long iterations;
+  long next;
+  std::chrono::steady_clock::time_point start_time{};
+  GenerationTrace trace;
+};
+
+// a trace along with where it came from, for export
+struct TraceSource {
+  std::string benchmark;
+  int job;
+  const GenerationTrace *trace;
+};
+
+/**
+ * @brief write traces to a file
+ *
+ * files ending in .csv get a "benchmark,job,generation,nanoseconds" table. anything else gets
+ * the binary format: the magic "CATRACE\0", u32 version (1), u32 name count, then each
+ * benchmark name as u32 length and bytes, u64 record count, and the records as
+ * {u32 benchmark index, u32 job, u64 generation, i64 nanoseconds}, all little-endian.
+ *
+ * @param path the file to write
+ * @param sources the traces
+ */
+void write_traces(const std::string &path, const std::vector<TraceSource> &sources);
@@ -0,0 +1,147 @@
+// Defines the per-host tuning cache written by the autotuner (see autotune.h): for each world size
+// and generation count it was tuned at, the engine configuration that ran fastest on this host.
+#include "tuning_cache.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "thread_pool.h"
+
+namespace ca {
+
+namespace {
+constexpr const char *CACHE_MAGIC = "# cellular automata tuning cache v1";
+
+// distance between two positive counts, by their ratio
+double log_distance(int a, int b) {
+  return std::abs(std::log2(static_cast<double>(std::max(a, 1)) / std::max(b, 1)));
+}
+} // namespace
+
+std::string TunedConfig::describe() const {
+  std::stringstream ss;
+  ss << benchmark;
+  if (tile_size > 0) ss << " tile_size=" << tile_size;
+  if (tile_generations > 0) ss << " tile_generations=" << tile_generations;
+  if (num_threads > 0) ss << " num_threads=" << num_threads;
+  return ss.str();
+}
+
+std::string host_name() {
+  char name[256] = {};
+  if (gethostname(name, sizeof(name) - 1) != 0 || name[0] == '\0') return "unknown";
+  return name;
+}
+
+std::string TuningCache::default_path() {
+  std::string name = host_name();
+  for (char &c : name) {
+    if (c == '/' || c == '\\' || c == ' ') c = '_';
+  }
+  return "tuning_" + name + ".cache";
+}
+
+TuningCache TuningCache::load(const std::string &path) {
+  TuningCache cache;
+  std::ifstream in(path);
+  if (!in.is_open()) return cache;
+
+  std::string line;
+  if (!std::getline(in, line) || line != CACHE_MAGIC) {
+    throw std::runtime_error(path + " is not a tuning cache");
+  }
+  // the host the timings were taken on
+  std::string keyword, host;
+  int threads = 0;
+  if (!std::getline(in, line) || !(std::istringstream(line) >> keyword >> host >> threads) ||
+      keyword != "host") {
+    throw std::runtime_error("missing host in tuning cache " + path);
+  }
+  if (host != host_name() || threads != hardware_threads()) {
+    std::cerr << "Ignoring " << path << ": tuned on " << host << " with " << threads
+              << " hardware threads, this is " << host_name() << " with " << hardware_threads()
+              << std::endl;
+    return cache;
+  }
+
+  // width_height iterations benchmark tile_size tile_generations num_threads seconds
+  for (int number = 3; std::getline(in, line); ++number) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream fields(line);
+    TunedConfig config;
+    if (!(fields >> config.width_height >> config.iterations >> config.benchmark >>
+          config.tile_size >> config.tile_generations >> config.num_threads >>
+          config.seconds_per_generation)) {
+      throw std::runtime_error("invalid configuration on line " + std::to_string(number) +
+                               " of " + path);
+    }
+    cache.insert(config);
+  }
+  return cache;
+}
+
+void TuningCache::save(const std::string &path) const {
+  const std::string temporary = path + ".tmp";
+  {
+    std::ofstream out(temporary);
+    if (!out.is_open()) {
+      throw std::runtime_error("Failed to open file: " + temporary);
+    }
+    out << CACHE_MAGIC << "\n";
+    out << "host " << host_name() << " " << hardware_threads() << "\n";
+    out << "# width_height iterations benchmark tile_size tile_generations num_threads "
+           "seconds_per_generation\n";
+    out.precision(9);
+    for (const auto &config : entries) {
+      out << config.width_height << " " << config.iterations << " " << config.benchmark << " "
+          << config.tile_size << " " << config.tile_generations << " " << config.num_threads
+          << " " << config.seconds_per_generation << "\n";
+    }
+    if (!out) {
+      throw std::runtime_error("Failed to write file: " + temporary);
+    }
+  }
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    throw std::runtime_error("Failed to replace file: " + path);
+  }
+}
+
+void TuningCache::insert(const TunedConfig &config) {
+  for (auto &entry : entries) {
+    if (entry.width_height == config.width_height && entry.iterations == config.iterations) {
+      entry = config;
+      return;
+    }
+  }
+  entries.push_back(config);
+}
+
+const TunedConfig *TuningCache::find(int width_height, int iterations) const {
+  const TunedConfig *best = nullptr;
+  double best_size = std::numeric_limits<double>::infinity();
+  double best_iterations = std::numeric_limits<double>::infinity();
+  for (const auto &entry : entries) {
+    // untuned entries are only used when there is nothing else
+    const double size = entry.width_height > 0 ? log_distance(entry.width_height, width_height)
+                                               : std::numeric_limits<double>::max();
+    const double generations = entry.iterations > 0 ? log_distance(entry.iterations, iterations)
+                                                    : std::numeric_limits<double>::max();
+    if (best == nullptr || size < best_size ||
+        (size == best_size && generations < best_iterations)) {
+      best = &entry;
+      best_size = size;
+      best_iterations = generations;
+    }
+  }
+  return best;
+}
+
+} // namespace ca
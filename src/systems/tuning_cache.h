@@ -0,0 +1,68 @@
+// Defines the per-host tuning cache written by the autotuner (see autotune.h): for each world size
+// and generation count it was tuned at, the engine configuration that ran fastest on this host.
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace ca {
+
+// default generations of each trial run of the autotuner (fewer if the run itself is shorter)
+constexpr int TUNE_ITERATIONS = 64;
+
+// one engine configuration, and the run it was the fastest for
+struct TunedConfig {
+  // world edge length and generation count the configuration was tuned at. 0 matches any run
+  // (the configuration used before anything was tuned).
+  int width_height{0};
+  int iterations{0};
+  // benchmark name (see Benchmark::get_name) and its settings. 0 where it has no such setting.
+  std::string benchmark;
+  int tile_size{0};
+  int tile_generations{0};
+  int num_threads{0};
+  // median duration of the trial run, per generation
+  double seconds_per_generation{0};
+
+  // the benchmark and its settings, e.g. "cpu_temporal tile_size=128 tile_generations=4"
+  std::string describe() const;
+};
+
+// name of this host, which the cache is kept for
+std::string host_name();
+
+// The tuned configurations of one host. Stored as a text file: a header naming the host, then one
+// configuration per line.
+class TuningCache {
+public:
+  // the cache of this host in the working directory, tuning_<hostname>.cache
+  static std::string default_path();
+
+  /**
+   * @brief read a cache file. throws std::runtime_error if it cannot be parsed.
+   *
+   * a missing file gives an empty cache. so does a file tuned on another host (or with another
+   * number of hardware threads), with a warning, since its timings do not apply here.
+   */
+  static TuningCache load(const std::string &path);
+  // write the cache (through a temporary file, so a reader never sees half of it). throws
+  // std::runtime_error on failure.
+  void save(const std::string &path) const;
+
+  // add a configuration, replacing the one tuned at the same size and generation count
+  void insert(const TunedConfig &config);
+  /**
+   * @brief the configuration tuned for the run closest to the given one, or nullptr if empty
+   *
+   * world sizes are compared first, then generation counts, both by their ratio
+   */
+  const TunedConfig *find(int width_height, int iterations) const;
+
+  const std::vector<TunedConfig> &configs() const { return entries; }
+  bool empty() const { return entries.empty(); }
+
+private:
+  std::vector<TunedConfig> entries;
+};
+
+} // namespace ca
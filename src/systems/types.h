@@ -5,6 +5,8 @@
 #include <vector>
 #include <random>
 
+#include "buffer_pool.h"
+
 namespace ca {
 // A single cell can be represented with 1 bit, but the smallest addressable size is a byte:
 using cell_t = std::uint8_t;
@@ -13,9 +15,10 @@ using cell_t = std::uint8_t;
 using neighbors_t = std::uint8_t;
 
 // The state of a cellular automata world at a single point in time.
-// World is fixed-size.
+// World is fixed-size. The cells live in a pooled buffer (see BufferPool), so worlds created
+// and destroyed job after job reuse the same memory.
 struct World {
-  std::vector<cell_t> state;
+  pooled_vector<cell_t> state;
   int width;
   int height;
 
@@ -33,6 +36,10 @@ struct World {
     }
   }
 
+  // constructor for all-dead worlds
+  World(int width, int height)
+      : state(static_cast<size_t>(width) * height, 0), width(width), height(height) {}
+
   World() = default;
 
   unsigned long get_mem_size() {
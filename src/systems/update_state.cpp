@@ -1,7 +1,9 @@
-// Defines the CPU implementation of conway's game of life.
+// Defines the CPU implementation of life-like cellular automata (conway's game of life by default).
 // Defined here because it is shared between the benchmarking and the SDL2 preview code.
 #include "update_state.h"
 
+#include <bit>
+
 #include "types.h"
 
 namespace ca {
@@ -40,39 +42,57 @@ neighbors_t get_neighbors(const World &world, int x, int y) {
 }
 
 /**
- * @brief perform one iteration of conway's game of life
+ * @brief perform one iteration of a life-like rule
  *
  * @param read the current state of the world
  * @param write the next state of the world
+ * @param rule the birth/survival rule to apply
  */
-void update_state(const World &read, World &write) {
+void update_state(const World &read, World &write, Rule rule) {
   // iterate over each cell in the world
   for (int y = 0; y < read.height; y++) {
     for (int x = 0; x < read.width; x++) {
       // get the number of neighbors of the current cell
       neighbors_t neighbors = get_neighbors(read, x, y);
-      // apply the rules of conway's game of life
+      // living cells survive and dead cells are born according to the rule
+      bool alive = read.state[y * read.width + x] != 0;
+      write.state[y * read.width + x] = rule.next(alive, neighbors);
+    }
+  }
+}
 
-      if (read.state[y * read.width + x] != 0) // if cell is alive,
-      {
-        if (neighbors < 2 || neighbors > 3) //   if cell has less than 2 or more than 3 neighbors,
-        {
-          write.state[y * read.width + x] = 0; //     cell dies
-        } else                                 //   if cell has 2 or 3 neighbors,
-        {
-          write.state[y * read.width + x] = 1; //     cell remains alive
-        }
-      } else // if cell is dead,
-      {
-        if (neighbors == 3) //   if cell has exactly 3 neighbors,
-        {
-          write.state[y * read.width + x] = 1; //     cell becomes alive
-        } else                                 //   if cell has any other number of neighbors,
-        {
-          write.state[y * read.width + x] = 0; //     cell remains dead
-        }
+/**
+ * @brief perform one iteration of a life-like rule, and reduce the new state in the same pass
+ *
+ * @param read the current state of the world
+ * @param write the next state of the world
+ * @param rule the birth/survival rule to apply
+ * @return population, changed cells and hash of the new state
+ */
+StepStats update_state_counted(const World &read, World &write, Rule rule) {
+  const std::uint64_t words_per_row = (read.width + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+  StepStats stats;
+  for (int y = 0; y < read.height; y++) {
+    // pack the new cells into words as they are computed, so the hash matches the packed world
+    word_t word = 0;
+    word_t changed = 0;
+    for (int x = 0; x < read.width; x++) {
+      neighbors_t neighbors = get_neighbors(read, x, y);
+      bool alive = read.state[y * read.width + x] != 0;
+      bool next = rule.next(alive, neighbors);
+      write.state[y * read.width + x] = next;
+      word |= static_cast<word_t>(next) << (x % CELLS_PER_WORD);
+      changed |= static_cast<word_t>(next != alive) << (x % CELLS_PER_WORD);
+      // flush at the end of each word and of the row
+      if (x % CELLS_PER_WORD == CELLS_PER_WORD - 1 || x == read.width - 1) {
+        stats.population += std::popcount(word);
+        stats.changed += std::popcount(changed);
+        stats.hash += step_word_hash(word, y * words_per_row + x / CELLS_PER_WORD);
+        word = 0;
+        changed = 0;
       }
     }
   }
+  return stats;
 }
 } // namespace ca
@@ -1,9 +1,14 @@
-// Defines the CPU implementation of conway's game of life.
+// Defines the CPU implementation of life-like cellular automata (conway's game of life by default).
 // Defined here because it is shared between the benchmarking and the SDL2 preview code.
 #pragma once
 
+#include "bit_world.h"
+#include "rule.h"
 #include "types.h"
 
 namespace ca {
-void update_state(const World &read, World &write);
+void update_state(const World &read, World &write, Rule rule);
+// same as update_state, but also returns the population, changed cells and hash of the new state
+// (the same StepStats that update_bit_state_counted returns for the packed world)
+StepStats update_state_counted(const World &read, World &write, Rule rule);
 }
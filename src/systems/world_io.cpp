@@ -0,0 +1,428 @@
+// Defines a compact, versioned binary checkpoint format for cellular automata state (saved and
+// loaded through mmap), along with importers for the standard RLE and plaintext pattern formats.
+#include "world_io.h"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ca {
+
+// the payload is the in-memory word array, so the format is only portable between
+// little-endian hosts (which is all of the ones we run on)
+static_assert(std::endian::native == std::endian::little, "checkpoints assume a little-endian host");
+
+namespace {
+// payload control word flag: the low bits are a run length and one word to repeat follows.
+// without it, the low bits are a count of literal words that follow.
+constexpr word_t RUN_FLAG = word_t{1} << 63;
+// shorter runs are cheaper to store as literals
+constexpr size_t MIN_RUN = 3;
+
+std::runtime_error io_error(const std::string &what, const std::string &path) {
+  return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+// RAII wrapper around a memory mapped file
+class MappedFile {
+public:
+  // map an existing file read-only
+  explicit MappedFile(const std::string &path) {
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw io_error("failed to open", path);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      throw io_error("failed to stat", path);
+    }
+    length = static_cast<size_t>(st.st_size);
+    map(path, PROT_READ, MAP_PRIVATE);
+  }
+
+  // create (or truncate) a file of the given size and map it for writing
+  MappedFile(const std::string &path, size_t size) : length(size) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw io_error("failed to create", path);
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      close(fd);
+      throw io_error("failed to resize", path);
+    }
+    map(path, PROT_READ | PROT_WRITE, MAP_SHARED);
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  ~MappedFile() {
+    if (data != nullptr && data != MAP_FAILED) munmap(data, length);
+    close(fd);
+  }
+
+  char *bytes() const { return static_cast<char *>(data); }
+  size_t size() const { return length; }
+
+private:
+  void map(const std::string &path, int prot, int flags) {
+    // mmap rejects empty mappings. callers check the size against the header anyway.
+    if (length == 0) return;
+    data = mmap(nullptr, length, prot, flags, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      throw io_error("failed to map", path);
+    }
+    // both loading and saving stream through the file front to back
+    madvise(data, length, MADV_SEQUENTIAL);
+  }
+
+  int fd{-1};
+  void *data{nullptr};
+  size_t length{0};
+};
+
+// inverse of rle_encode. throws if the input does not decode to exactly out_words words.
+void rle_decode(const word_t *in, size_t in_words, word_t *out, size_t out_words) {
+  const std::runtime_error corrupt("corrupt checkpoint payload");
+  size_t i = 0;
+  size_t o = 0;
+  while (i < in_words) {
+    word_t control = in[i++];
+    size_t count = control & ~RUN_FLAG;
+    if (count > out_words - o) throw corrupt;
+    if (control & RUN_FLAG) {
+      if (i >= in_words) throw corrupt;
+      std::fill_n(out + o, count, in[i++]);
+    } else {
+      if (count > in_words - i) throw corrupt;
+      std::copy_n(in + i, count, out + o);
+      i += count;
+    }
+    o += count;
+  }
+  if (o != out_words) throw corrupt;
+}
+
+std::string read_text(const std::string &path) {
+  std::ifstream file(path);
+  if (!file.is_open()) throw io_error("failed to open", path);
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+std::string trim(const std::string &s) {
+  const char *space = " \t\r\n";
+  size_t begin = s.find_first_not_of(space);
+  if (begin == std::string::npos) return "";
+  return s.substr(begin, s.find_last_not_of(space) - begin + 1);
+}
+
+// parse the rule field of an RLE header: "B3/S23", or the older "23/3" (survival/birth) notation
+Rule parse_pattern_rule(std::string text) {
+  // drop Golly's bounded grid suffix (e.g. "B3/S23:T100,100")
+  text = trim(text.substr(0, text.find(':')));
+  if (text.find_first_of("BbSs") != std::string::npos) return parse_rule(text);
+  size_t slash = text.find('/');
+  if (slash == std::string::npos) throw std::invalid_argument("invalid rule in pattern: " + text);
+  return parse_rule("B" + text.substr(slash + 1) + "/S" + text.substr(0, slash));
+}
+
+// an all-dead world, used as the canvas for patterns
+World empty_world(int width, int height) {
+  World world;
+  world.width = width;
+  world.height = height;
+  world.state.assign(static_cast<size_t>(width) * height, 0);
+  return world;
+}
+
+// parse the checkpoint at the start of bytes (size bytes are available). consumed receives the
+// size of the checkpoint, header included.
+Checkpoint parse_checkpoint(const char *bytes, size_t size, const std::string &path,
+                            size_t &consumed) {
+  if (size < sizeof(CheckpointHeader)) {
+    throw std::runtime_error("not a checkpoint (too short): " + path);
+  }
+  CheckpointHeader header;
+  std::memcpy(&header, bytes, sizeof(header));
+  if (std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0) {
+    throw std::runtime_error("not a checkpoint (bad magic): " + path);
+  }
+  if (header.version != CHECKPOINT_VERSION) {
+    throw std::runtime_error("unsupported checkpoint version " + std::to_string(header.version) +
+                             ": " + path);
+  }
+  if (header.width == 0 || header.height == 0 || header.width > INT32_MAX ||
+      header.height > INT32_MAX) {
+    throw std::runtime_error("invalid checkpoint dimensions: " + path);
+  }
+  if (header.payload_bytes > size - sizeof(header) ||
+      header.payload_bytes % sizeof(word_t) != 0) {
+    throw std::runtime_error("truncated checkpoint: " + path);
+  }
+  consumed = sizeof(header) + header.payload_bytes;
+
+  Checkpoint checkpoint;
+  checkpoint.rule = Rule{header.birth, header.survival};
+  checkpoint.generation = header.generation;
+  BitWorld &state = checkpoint.state;
+  state.width = static_cast<int>(header.width);
+  state.height = static_cast<int>(header.height);
+  state.words_per_row = (state.width + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+  const size_t words = static_cast<size_t>(state.words_per_row) * state.height;
+
+  // fill the words straight from the mapping, without zeroing them first
+  const word_t *payload = reinterpret_cast<const word_t *>(bytes + sizeof(header));
+  const size_t payload_words = header.payload_bytes / sizeof(word_t);
+  if (header.flags & CHECKPOINT_RLE) {
+    state.words.resize(words);
+    rle_decode(payload, payload_words, state.words.data(), words);
+  } else {
+    if (payload_words != words) throw std::runtime_error("truncated checkpoint: " + path);
+    state.words.assign(payload, payload + payload_words);
+  }
+
+  // the kernels rely on the padding bits being clear, so do not trust the file for those
+  const word_t mask = state.last_word_mask();
+  for (int y = 0; y < state.height; y++) {
+    state.words[static_cast<size_t>(y + 1) * state.words_per_row - 1] &= mask;
+  }
+  return checkpoint;
+}
+} // namespace
+
+// each run of at least MIN_RUN words costs two words, which pays for the control word of the
+// literals after it. so the output is at most one word longer than the input.
+size_t rle_encode(const word_t *in, size_t n, word_t *out) {
+  size_t size = 0;
+  auto emit = [&](word_t w) {
+    if (out != nullptr) out[size] = w;
+    size++;
+  };
+  size_t literal_start = 0;
+  auto flush_literals = [&](size_t end) {
+    if (end == literal_start) return;
+    emit(end - literal_start);
+    for (size_t k = literal_start; k < end; k++) emit(in[k]);
+  };
+
+  size_t i = 0;
+  while (i < n) {
+    size_t run = 1;
+    while (i + run < n && in[i + run] == in[i]) run++;
+    if (run >= MIN_RUN) {
+      flush_literals(i);
+      emit(RUN_FLAG | run);
+      emit(in[i]);
+      literal_start = i + run;
+    }
+    i += run;
+  }
+  flush_literals(n);
+  return size;
+}
+
+CheckpointHeader make_checkpoint_header(int width, int height, Rule rule,
+                                        std::uint64_t generation, bool compressed,
+                                        std::uint64_t payload_bytes) {
+  CheckpointHeader header{};
+  std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+  header.version = CHECKPOINT_VERSION;
+  header.flags = compressed ? CHECKPOINT_RLE : 0;
+  header.width = static_cast<std::uint64_t>(width);
+  header.height = static_cast<std::uint64_t>(height);
+  header.generation = generation;
+  header.payload_bytes = payload_bytes;
+  header.birth = rule.birth;
+  header.survival = rule.survival;
+  return header;
+}
+
+void save_checkpoint(const std::string &path, const BitWorld &state, Rule rule,
+                     std::uint64_t generation, bool compress) {
+  const size_t words = state.words.size();
+  // size the file up front (a counting pass when compressing), then write straight into the map
+  const size_t payload_words = compress ? rle_encode(state.words.data(), words, nullptr) : words;
+  const size_t payload_bytes = payload_words * sizeof(word_t);
+
+  MappedFile file(path, sizeof(CheckpointHeader) + payload_bytes);
+  const CheckpointHeader header =
+      make_checkpoint_header(state.width, state.height, rule, generation, compress, payload_bytes);
+  std::memcpy(file.bytes(), &header, sizeof(header));
+
+  // the header is 64 bytes and the map is page aligned, so the payload is word aligned
+  word_t *payload = reinterpret_cast<word_t *>(file.bytes() + sizeof(header));
+  if (compress) {
+    rle_encode(state.words.data(), words, payload);
+  } else {
+    std::memcpy(payload, state.words.data(), payload_bytes);
+  }
+}
+
+Checkpoint load_checkpoint(const std::string &path) {
+  MappedFile file(path);
+  size_t consumed = 0;
+  Checkpoint checkpoint = parse_checkpoint(file.bytes(), file.size(), path, consumed);
+  if (consumed != file.size()) throw std::runtime_error("truncated checkpoint: " + path);
+  return checkpoint;
+}
+
+std::vector<Checkpoint> load_recording(const std::string &path) {
+  MappedFile file(path);
+  std::vector<Checkpoint> snapshots;
+  size_t offset = 0;
+  while (offset < file.size()) {
+    size_t consumed = 0;
+    snapshots.push_back(parse_checkpoint(file.bytes() + offset, file.size() - offset, path,
+                                         consumed));
+    offset += consumed;
+  }
+  return snapshots;
+}
+
+bool is_checkpoint(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  char magic[sizeof(CHECKPOINT_MAGIC)];
+  return file.read(magic, sizeof(magic)) &&
+         std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) == 0;
+}
+
+LoadedWorld parse_rle(const std::string &rle, const std::string &source) {
+  std::istringstream text(rle);
+  LoadedWorld loaded;
+  int width = -1;
+  int height = -1;
+
+  // comment lines start with '#'. the first other line is the header.
+  std::string line;
+  while (std::getline(text, line)) {
+    line = trim(line);
+    if (line.empty() || line[0] == '#') continue;
+    std::stringstream fields(line);
+    std::string field;
+    while (std::getline(fields, field, ',')) {
+      size_t eq = field.find('=');
+      if (eq == std::string::npos) throw std::runtime_error("invalid RLE header in " + source);
+      std::string key = trim(field.substr(0, eq));
+      std::string value = trim(field.substr(eq + 1));
+      if (key == "x") {
+        width = std::stoi(value);
+      } else if (key == "y") {
+        height = std::stoi(value);
+      } else if (key == "rule") {
+        loaded.rule = parse_pattern_rule(value);
+        loaded.has_rule = true;
+      }
+    }
+    break;
+  }
+  if (width <= 0 || height <= 0) throw std::runtime_error("missing RLE dimensions in " + source);
+  loaded.world = empty_world(width, height);
+
+  // the body: <count><tag> items, where b is dead, o (or any other letter) is alive and
+  // $ ends a row. whitespace is insignificant and ! ends the pattern.
+  int x = 0;
+  int y = 0;
+  int count = 0;
+  char c;
+  while (text.get(c) && c != '!') {
+    if (c >= '0' && c <= '9') {
+      count = count * 10 + (c - '0');
+      continue;
+    }
+    const int n = std::max(count, 1);
+    count = 0;
+    if (c == '$') {
+      y += n;
+      x = 0;
+    } else if (c == 'b' || c == '.') {
+      x += n;
+    } else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+      if (y >= height || x + n > width) {
+        throw std::runtime_error("RLE pattern exceeds its declared size in " + source);
+      }
+      std::fill_n(&loaded.world.state[static_cast<size_t>(y) * width + x], n, 1);
+      x += n;
+    } else if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+      throw std::runtime_error(std::string("invalid character '") + c + "' in RLE body of " + source);
+    }
+  }
+  return loaded;
+}
+
+LoadedWorld load_rle(const std::string &path) {
+  return parse_rle(read_text(path), path);
+}
+
+LoadedWorld load_plaintext(const std::string &path) {
+  std::istringstream text(read_text(path));
+  std::vector<std::string> rows;
+  size_t width = 0;
+  std::string line;
+  while (std::getline(text, line)) {
+    if (!line.empty() && line[0] == '!') continue;
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    width = std::max(width, line.size());
+    rows.push_back(line);
+  }
+  if (width == 0 || rows.empty()) throw std::runtime_error("empty plaintext pattern: " + path);
+
+  LoadedWorld loaded;
+  loaded.world = empty_world(static_cast<int>(width), static_cast<int>(rows.size()));
+  for (size_t y = 0; y < rows.size(); y++) {
+    for (size_t x = 0; x < rows[y].size(); x++) {
+      char c = rows[y][x];
+      loaded.world.state[y * width + x] = c == 'O' || c == 'o' || c == '*';
+    }
+  }
+  return loaded;
+}
+
+World place_pattern(const World &pattern, int width, int height) {
+  if (pattern.width > width || pattern.height > height) {
+    throw std::invalid_argument("pattern of size " + std::to_string(pattern.width) + "x" +
+                                std::to_string(pattern.height) + " does not fit in a " +
+                                std::to_string(width) + "x" + std::to_string(height) + " world");
+  }
+  World world = empty_world(width, height);
+  const int ox = (width - pattern.width) / 2;
+  const int oy = (height - pattern.height) / 2;
+  for (int y = 0; y < pattern.height; y++) {
+    std::copy_n(&pattern.state[static_cast<size_t>(y) * pattern.width], pattern.width,
+                &world.state[static_cast<size_t>(y + oy) * width + ox]);
+  }
+  return world;
+}
+
+LoadedWorld load_world(const std::string &path, int width, int height) {
+  if (is_checkpoint(path)) {
+    Checkpoint checkpoint = load_checkpoint(path);
+    return LoadedWorld{checkpoint.state.to_world(), checkpoint.rule, true, checkpoint.generation};
+  }
+
+  // RLE files start with their header line (after any '#' comments), which begins with "x"
+  bool rle = false;
+  std::istringstream text(read_text(path));
+  std::string line;
+  while (std::getline(text, line)) {
+    line = trim(line);
+    if (line.empty() || line[0] == '#') continue;
+    rle = line[0] == 'x';
+    break;
+  }
+
+  LoadedWorld loaded = rle ? load_rle(path) : load_plaintext(path);
+  loaded.world = place_pattern(loaded.world, width > 0 ? width : loaded.world.width,
+                               height > 0 ? height : loaded.world.height);
+  return loaded;
+}
+
+} // namespace ca
@@ -0,0 +1,118 @@
+// Defines a compact, versioned binary checkpoint format for cellular automata state (saved and
+// loaded through mmap), along with importers for the standard RLE and plaintext pattern formats.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bit_world.h"
+#include "rule.h"
+#include "types.h"
+
+namespace ca {
+
+// Checkpoint file layout (all fields little-endian):
+//   CheckpointHeader (64 bytes)
+//   payload: the BitWorld words row by row (height * words_per_row words), either stored as-is,
+//   or, with the CHECKPOINT_RLE flag, as word-level runs (see save_checkpoint).
+constexpr char CHECKPOINT_MAGIC[8] = {'C', 'A', 'W', 'O', 'R', 'L', 'D', '\0'};
+constexpr std::uint32_t CHECKPOINT_VERSION = 1;
+// header flags
+constexpr std::uint32_t CHECKPOINT_RLE = 1;
+
+struct CheckpointHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t flags;
+  std::uint64_t width;
+  std::uint64_t height;
+  std::uint64_t generation;
+  // size of the payload following the header, in bytes
+  std::uint64_t payload_bytes;
+  std::uint16_t birth;
+  std::uint16_t survival;
+  std::uint8_t reserved[12];
+};
+static_assert(sizeof(CheckpointHeader) == 64, "checkpoint header must stay 64 bytes");
+
+// state loaded from a checkpoint
+struct Checkpoint {
+  BitWorld state;
+  Rule rule{CONWAY};
+  std::uint64_t generation{0};
+};
+
+/**
+ * @brief write a checkpoint through a shared memory mapping of the output file
+ *
+ * @param path file to create (or overwrite)
+ * @param state the world to save
+ * @param rule the rule the world is evolving under
+ * @param generation number of generations the world has been advanced
+ * @param compress run-length encode the payload. mostly empty or settled worlds shrink a lot;
+ * random soups do not, and are better saved uncompressed.
+ */
+void save_checkpoint(const std::string &path, const BitWorld &state, Rule rule,
+                     std::uint64_t generation, bool compress);
+
+// read a checkpoint through a read-only memory mapping. throws std::runtime_error on bad files.
+Checkpoint load_checkpoint(const std::string &path);
+
+// read a recording: checkpoints stored back to back, as written by SnapshotRecorder
+std::vector<Checkpoint> load_recording(const std::string &path);
+
+// the header of a checkpoint with the given contents
+CheckpointHeader make_checkpoint_header(int width, int height, Rule rule,
+                                        std::uint64_t generation, bool compressed,
+                                        std::uint64_t payload_bytes);
+
+/**
+ * @brief run-length encode words into control words, literals and runs (the CHECKPOINT_RLE
+ * payload format)
+ *
+ * @param in the words to encode
+ * @param n number of words
+ * @param out destination, or nullptr to only compute the encoded size. never needs more than
+ * n + 1 words.
+ * @return size_t encoded size, in words
+ */
+size_t rle_encode(const word_t *in, size_t n, word_t *out);
+
+// does the file start with the checkpoint magic?
+bool is_checkpoint(const std::string &path);
+
+// a world read from a file, along with the rule and generation it carries (if any)
+struct LoadedWorld {
+  World world;
+  Rule rule{CONWAY};
+  // false if the file does not name a rule (plaintext files, RLE files without a rule field)
+  bool has_rule{false};
+  std::uint64_t generation{0};
+};
+
+// import an RLE pattern file (the "x = m, y = n, rule = B3/S23" format). the world is sized
+// to the pattern's bounding box.
+LoadedWorld load_rle(const std::string &path);
+
+// parse RLE text that is already in memory. source names it in error messages.
+LoadedWorld parse_rle(const std::string &rle, const std::string &source = "RLE text");
+
+// import a plaintext (.cells) pattern file: '!' comment lines, '.' dead and 'O' living cells
+LoadedWorld load_plaintext(const std::string &path);
+
+// copy a pattern into the center of an all-dead world of the given size.
+// throws std::invalid_argument if the pattern does not fit.
+World place_pattern(const World &pattern, int width, int height);
+
+/**
+ * @brief load a world from a checkpoint, RLE or plaintext file (detected from the contents)
+ *
+ * @param path the file to load
+ * @param width width of the world patterns are placed in (0 to use the pattern's own width).
+ * checkpoints always keep their own dimensions.
+ * @param height height of the world patterns are placed in (0 to use the pattern's own height)
+ */
+LoadedWorld load_world(const std::string &path, int width, int height);
+
+} // namespace ca